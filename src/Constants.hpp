@@ -19,6 +19,9 @@
 namespace Constants {
     constexpr QAnyStringView PROJECT_FILE_FILTER = "*.simtagproj";
     constexpr QAnyStringView TAGS_FILE_SUFFIX = ".simtags.cbor";
+
+    // appended to the project file path
+    constexpr QAnyStringView PROJECT_INDEX_FILE_SUFFIX = ".simtagindex.cbor";
 }
 
 namespace SettingsKey {
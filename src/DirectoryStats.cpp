@@ -28,7 +28,7 @@ const QStringList IMAGE_FILE_SUFFIXES = {".jpg", ".png"};
 }
 
 DirectoryStats::DirectoryStats(DirectoryStatsManager &manager, QString const &path):
-        manager_(manager), path_(path) {
+        manager_(manager), path_(path), totals_(std::make_shared<Counters const>(computeTotals())) {
     gsl_Expects(QFileInfo(path_).isAbsolute());
     gsl_Expects(QFileInfo(path_).isDir());
 }
@@ -40,109 +40,49 @@ QString DirectoryStats::path() const {
 }
 
 int DirectoryStats::fileCount() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.fileCount_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().fileCount(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->fileCount_;
 }
 
 int DirectoryStats::filesExcluded() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-
-    if (stats_.isExcluded_)
-        return stats_.fileCount_;
-    else
-        return stats_.filesExcluded_ + std::ranges::fold_left_first(
-                stats_.childrenStats_ | std::views::transform([](auto const &v){
-                    return v.get().filesExcluded();
-                }),
-                std::plus<int>()
-        ).value_or(0);
+    return totals()->filesExcluded_;
 }
 
 int DirectoryStats::filesFlaggedComplete() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.filesFlaggedComplete_  + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().filesFlaggedComplete(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->filesFlaggedComplete_;
 }
 
 int DirectoryStats::filesFlaggedCompleteWithoutExcluded() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.filesFlaggedCompleteWithoutExcluded_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().filesFlaggedCompleteWithoutExcluded(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->filesFlaggedCompleteWithoutExcluded_;
 }
 
 int DirectoryStats::filesWithTags() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.filesWithTags_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().filesWithTags(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->filesWithTags_;
 }
 
 int DirectoryStats::filesWithTagsWithoutExcluded() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.filesWithTagsWithoutExcluded_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().filesWithTagsWithoutExcluded(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->filesWithTagsWithoutExcluded_;
 }
 
 int DirectoryStats::filesOtherTagLibrary() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.filesOtherTagLibrary_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().filesOtherTagLibrary(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->filesOtherTagLibrary_;
 }
 
 int DirectoryStats::filesOtherTagLibraryVersion() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.filesOtherTagLibraryVersion_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().filesOtherTagLibraryVersion(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->filesOtherTagLibraryVersion_;
 }
 
 int DirectoryStats::totalTags() const {
-    ZoneScoped;
     gsl_Expects(ready());
-
-    QMutexLocker locker(&mutex_);
-    return stats_.totalTags_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().totalTags(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->totalTags_;
 }
 
 int DirectoryStats::unknownTags() const {
-    ZoneScoped;
     gsl_Expects(ready());
-
-    QMutexLocker locker(&mutex_);
-    return stats_.unknownTags_ + std::ranges::fold_left_first(
-            stats_.childrenStats_ | std::views::transform([](auto const &v){ return v.get().unknownTags(); }),
-            std::plus<int>()
-    ).value_or(0);
+    return totals()->unknownTags_;
 }
 
 bool DirectoryStats::ready() const {
-    ZoneScoped;
-    QMutexLocker locker(&mutex_);
-    return stats_.loaded_ && std::ranges::all_of(stats_.childrenStats_, [](auto const &v){ return v.get().ready(); });
+    return totals()->directoriesNotLoaded_ == 0;
 }
 
 void DirectoryStats::reload() {
@@ -151,18 +91,25 @@ void DirectoryStats::reload() {
     gsl_Expects(QFileInfo(path_).isAbsolute());
 
     {
-        QMutexLocker locker(&mutex_);
-        stats_.loaded_ = false;
+        QStringList changedPaths;
+        {
+            QMutexLocker locker(&manager_.aggregationMutex_);
+            loaded_ = false;
+            updateTotals(changedPaths);
+        }
+        emitStatsUpdate(changedPaths);
     }
 
-    emitStatsUpdate();
-
     manager_.threadPool_.start([this](){
         //qDebug() << "Loading directory stats for" << path_;
 
-        Stats stats;
+        Counters stats;
+        std::unordered_map<QString, Counters> files;
+        std::vector<std::reference_wrapper<DirectoryStats>> childrenStats;
 
-        stats.isExcluded_ = manager_.project_->isExcludedFile(QDir(manager_.project_->rootDir()).relativeFilePath(path_));
+        auto knownTags = manager_.knownTags();
+
+        bool isDirectoryExcluded = manager_.project_->isExcludedFile(QDir(manager_.project_->rootDir()).relativeFilePath(path_));
 
         QDirIterator iterator(path_, QDir::Filter::AllEntries | QDir::Filter::NoDotAndDotDot);
         while (iterator.hasNext()) {
@@ -171,62 +118,18 @@ void DirectoryStats::reload() {
 
             auto info = iterator.nextFileInfo();
             if (info.isDir()) {
-                stats.childrenStats_.push_back(manager_.directoryStats(info.filePath()));
+                childrenStats.push_back(manager_.directoryStats(info.filePath()));
             } else if (IMAGE_FILE_SUFFIXES.contains("."+info.suffix())) {
-                auto tags = manager_.fileTagsManager_.forFile(info.absoluteFilePath());
-                if (!tags) {
-                    qWarning() << "Couldn't get tags information for file" << info.absoluteFilePath() << "; this data won't be taken into account for statistics calculation";
+                auto counters = fileCounters(info, knownTags->tags);
+                if (!counters)
                     continue;
-                }
-
-                bool isExcluded = manager_.project_->isExcludedFile(
-                        QDir(manager_.project_->rootDir()).relativeFilePath(info.absoluteFilePath())
-                );
-
-                stats.fileCount_ += 1;
-
-                if (isExcluded)
-                    stats.filesExcluded_ += 1;
-
-                auto size = tags->get().assignedTags().size();
-                if (size != 0) {
-                    stats.filesWithTags_ += 1;
-
-                    if (!isExcluded)
-                        stats.filesWithTagsWithoutExcluded_ += 1;
-                }
-
-                if (tags->get().isCompleteFlag()) {
-                    stats.filesFlaggedComplete_ += 1;
-
-                    if (!isExcluded)
-                        stats.filesFlaggedCompleteWithoutExcluded_ += 1;
-                }
-
-                if (size != 0) {
-                    if (auto tagLibrary = tags->get().tagLibraryUuid();
-                            !tagLibrary || (*tagLibrary != manager_.tagLibrary_->getUuid())) {
-                        stats.filesOtherTagLibrary_ += 1;
-                    } else if (auto tagLibraryVersion = tags->get().tagLibraryVersionUuid();
-                            !tagLibraryVersion || (*tagLibraryVersion != manager_.tagLibrary_->getVersionUuid())) {
-                        stats.filesOtherTagLibraryVersion_ += 1;
-                    }
-                }
-
-                stats.totalTags_ += size;
-
-                stats.unknownTags_ += std::ranges::count_if(
-                        tags->get().assignedTags(),
-                        [&](auto const &tag){
-                                return !manager_.knownTags().contains(tag);
-                        }
-                );
+
+                stats += *counters;
+                files.emplace(info.absoluteFilePath(), *counters);
             }
         };
 
-        stats.loaded_ = true;
-
-        //qDebug() << "Loaded directory stats for" << path_ << ": fileCount:" << stats.fileCount_ << "; filesWithTags:" << stats.filesWithTags_ << "; totalTags:" << stats.totalTags_ << "; childrenStats (count):" << stats.childrenStats_.size();
+        //qDebug() << "Loaded directory stats for" << path_ << ": fileCount:" << stats.fileCount_ << "; filesWithTags:" << stats.filesWithTags_ << "; totalTags:" << stats.totalTags_ << "; childrenStats (count):" << childrenStats.size();
 
         gsl_Ensures(stats.filesExcluded_ >= 0);
         gsl_Ensures(stats.filesExcluded_ <= stats.fileCount_);
@@ -245,15 +148,204 @@ void DirectoryStats::reload() {
 
         gsl_Ensures(stats.totalTags_ >= 0);
 
+        QStringList changedPaths;
+        QSet<QString> pendingFiles;
         {
-            QMutexLocker locker(&mutex_);
-            stats_ = stats;
+            QMutexLocker locker(&manager_.aggregationMutex_);
+
+            for (auto &child: childrenStats_)
+                if (child.get().parent_ == this)
+                    child.get().parent_ = nullptr;
+
+            // children totals are re-summed once here, any later change of a child comes as a delta
+            childrenStats_ = std::move(childrenStats);
+            childrenTotals_ = {};
+            for (auto &child: childrenStats_) {
+                child.get().parent_ = this;
+                childrenTotals_ += *child.get().totals();
+            }
+
+            own_ = stats;
+            files_ = std::move(files);
+            isExcluded_ = isDirectoryExcluded;
+            loaded_ = true;
+            pendingFiles = std::exchange(pendingFiles_, {});
+
+            updateTotals(changedPaths);
         }
 
-        emitStatsUpdate();
+        emitStatsUpdate(changedPaths);
+
+        // the scan might have passed them before they changed
+        for (auto const &path: pendingFiles)
+            reloadFile(path);
     });
 }
 
-void DirectoryStats::emitStatsUpdate() {
-    emit manager_.directoryStatsChanged(path_);
+void DirectoryStats::reloadFile(QString const &path) {
+    gsl_Expects(manager_.project_);
+    gsl_Expects(manager_.tagLibrary_);
+    gsl_Expects(QFileInfo(path).isAbsolute());
+    gsl_Expects(QFileInfo(path).path() == path_);
+
+    manager_.threadPool_.start([this, path](){
+        ZoneScoped;
+
+        if (manager_.threadPoolInterrupt_.test())
+            return;
+
+        // nullopt for an image that's gone, or whose tags can't be loaded; either way it's not counted
+        QFileInfo info{path};
+        auto counters = info.exists() ? fileCounters(info, manager_.knownTags()->tags) : std::nullopt;
+
+        QStringList changedPaths;
+        {
+            QMutexLocker locker(&manager_.aggregationMutex_);
+
+            if (!loaded_) {
+                pendingFiles_.insert(path);
+                return;
+            }
+
+            if (auto it = files_.find(path); it != files_.end()) {
+                own_ -= it->second;
+                files_.erase(it);
+            }
+
+            if (counters) {
+                own_ += *counters;
+                files_.emplace(path, *counters);
+            }
+
+            updateTotals(changedPaths);
+        }
+
+        emitStatsUpdate(changedPaths);
+    });
+}
+
+std::optional<DirectoryStats::Counters> DirectoryStats::fileCounters(QFileInfo const &info, QSet<TagId> const &knownTags) const {
+    ZoneScoped;
+
+    auto tags = manager_.fileTagsManager_.forFile(info.absoluteFilePath());
+    if (!tags) {
+        qWarning() << "Couldn't get tags information for file" << info.absoluteFilePath() << "; this data won't be taken into account for statistics calculation";
+        return std::nullopt;
+    }
+
+    bool isExcluded = manager_.project_->isExcludedFile(
+            QDir(manager_.project_->rootDir()).relativeFilePath(info.absoluteFilePath())
+    );
+
+    Counters stats;
+    stats.fileCount_ += 1;
+
+    if (isExcluded)
+        stats.filesExcluded_ += 1;
+
+    auto assignedTags = (*tags)->assignedTagIds();
+    auto size = assignedTags.size();
+    if (size != 0) {
+        stats.filesWithTags_ += 1;
+
+        if (!isExcluded)
+            stats.filesWithTagsWithoutExcluded_ += 1;
+    }
+
+    if ((*tags)->isCompleteFlag()) {
+        stats.filesFlaggedComplete_ += 1;
+
+        if (!isExcluded)
+            stats.filesFlaggedCompleteWithoutExcluded_ += 1;
+    }
+
+    if (size != 0) {
+        if (auto tagLibrary = (*tags)->tagLibraryUuid();
+                !tagLibrary || (*tagLibrary != manager_.tagLibrary_->getUuid())) {
+            stats.filesOtherTagLibrary_ += 1;
+        } else if (auto tagLibraryVersion = (*tags)->tagLibraryVersionUuid();
+                !tagLibraryVersion || (*tagLibraryVersion != manager_.tagLibrary_->getVersionUuid())) {
+            stats.filesOtherTagLibraryVersion_ += 1;
+        }
+    }
+
+    stats.totalTags_ += size;
+
+    stats.unknownTags_ += std::ranges::count_if(
+            assignedTags,
+            [&](auto const tag){
+                    return !knownTags.contains(tag);
+            }
+    );
+
+    return stats;
+}
+
+DirectoryStats::Counters &DirectoryStats::Counters::operator+=(Counters const &other) {
+    fileCount_ += other.fileCount_;
+    filesExcluded_ += other.filesExcluded_;
+    filesFlaggedComplete_ += other.filesFlaggedComplete_;
+    filesFlaggedCompleteWithoutExcluded_ += other.filesFlaggedCompleteWithoutExcluded_;
+    filesWithTags_ += other.filesWithTags_;
+    filesWithTagsWithoutExcluded_ += other.filesWithTagsWithoutExcluded_;
+    filesOtherTagLibrary_ += other.filesOtherTagLibrary_;
+    filesOtherTagLibraryVersion_ += other.filesOtherTagLibraryVersion_;
+    totalTags_ += other.totalTags_;
+    unknownTags_ += other.unknownTags_;
+    directoriesNotLoaded_ += other.directoriesNotLoaded_;
+    return *this;
+}
+
+DirectoryStats::Counters &DirectoryStats::Counters::operator-=(Counters const &other) {
+    fileCount_ -= other.fileCount_;
+    filesExcluded_ -= other.filesExcluded_;
+    filesFlaggedComplete_ -= other.filesFlaggedComplete_;
+    filesFlaggedCompleteWithoutExcluded_ -= other.filesFlaggedCompleteWithoutExcluded_;
+    filesWithTags_ -= other.filesWithTags_;
+    filesWithTagsWithoutExcluded_ -= other.filesWithTagsWithoutExcluded_;
+    filesOtherTagLibrary_ -= other.filesOtherTagLibrary_;
+    filesOtherTagLibraryVersion_ -= other.filesOtherTagLibraryVersion_;
+    totalTags_ -= other.totalTags_;
+    unknownTags_ -= other.unknownTags_;
+    directoriesNotLoaded_ -= other.directoriesNotLoaded_;
+    return *this;
+}
+
+std::shared_ptr<DirectoryStats::Counters const> DirectoryStats::totals() const {
+    return totals_.load(std::memory_order_acquire);
+}
+
+DirectoryStats::Counters DirectoryStats::computeTotals() const {
+    Counters totals = own_;
+    totals += childrenTotals_;
+
+    // whole directory excluded - only its own files are counted as excluded
+    if (isExcluded_)
+        totals.filesExcluded_ = own_.fileCount_;
+
+    totals.directoriesNotLoaded_ = (loaded_ ? 0 : 1) + childrenTotals_.directoriesNotLoaded_;
+    return totals;
+}
+
+void DirectoryStats::updateTotals(QStringList &changedPaths) {
+    ZoneScoped;
+
+    auto newTotals = computeTotals();
+    auto oldTotals = totals();
+    if (newTotals == *oldTotals)
+        return;
+
+    totals_.store(std::make_shared<Counters const>(newTotals), std::memory_order_release);
+    changedPaths.push_back(path_);
+
+    if (parent_) {
+        parent_->childrenTotals_ += newTotals;
+        parent_->childrenTotals_ -= *oldTotals;
+        parent_->updateTotals(changedPaths);
+    }
+}
+
+void DirectoryStats::emitStatsUpdate(QStringList const &changedPaths) {
+    for (auto const &path: changedPaths)
+        emit manager_.directoryStatsChanged(path);
 }
@@ -15,6 +15,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #pragma once
+#include "TagDictionary.hpp"
 
 class DirectoryStatsManager;
 
@@ -49,19 +50,12 @@ public:
     bool ready() const;
 
     void reload();
+    // re-counts a single image of this directory, e.g. after its tags file changed, or it was created or removed
+    void reloadFile(QString const &path);
 
 private:
-    void emitStatsUpdate();
-
-    DirectoryStatsManager &manager_;
-    QString path_;
-
-    mutable QMutex mutex_;
-    struct Stats {
-        std::vector<std::reference_wrapper<DirectoryStats>> childrenStats_;
-
-        bool loaded_ = false;
-        bool isExcluded_ = false;
+    // Aggregated counters of a directory subtree. Subtraction is used to push deltas up to the parent chain.
+    struct Counters {
         int fileCount_ = 0;
         int filesExcluded_ = 0;
         int filesFlaggedComplete_ = 0;
@@ -72,7 +66,36 @@ private:
         int filesOtherTagLibraryVersion_ = 0;
         int totalTags_ = 0;
         int unknownTags_ = 0;
+        int directoriesNotLoaded_ = 0;
+
+        Counters &operator+=(Counters const &other);
+        Counters &operator-=(Counters const &other);
+        bool operator==(Counters const &other) const = default;
     };
 
-    Stats stats_;
+    // counters of a single image; nullopt if its tags couldn't be loaded
+    [[nodiscard]] std::optional<Counters> fileCounters(QFileInfo const &info, QSet<TagId> const &knownTags) const;
+
+    [[nodiscard]] std::shared_ptr<Counters const> totals() const;
+    [[nodiscard]] Counters computeTotals() const;
+    void updateTotals(QStringList &changedPaths);
+    void emitStatsUpdate(QStringList const &changedPaths);
+
+    DirectoryStatsManager &manager_;
+    QString path_;
+
+    // all below are guarded by manager_.aggregationMutex_
+    DirectoryStats *parent_ = nullptr;
+    std::vector<std::reference_wrapper<DirectoryStats>> childrenStats_;
+    Counters childrenTotals_;
+    Counters own_;
+    // per image contributions to own_, so that a single image can be re-counted
+    std::unordered_map<QString, Counters> files_;
+    // images changed while a reload was in progress, re-counted once it's done
+    QSet<QString> pendingFiles_;
+    bool loaded_ = false;
+    bool isExcluded_ = false;
+
+    // snapshot of own_ + childrenTotals_, replaced on every change so that getters don't need any locking
+    std::atomic<std::shared_ptr<Counters const>> totals_;
 };
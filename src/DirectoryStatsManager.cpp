@@ -33,7 +33,14 @@ void DirectoryStatsManager::setProject(Project *const project) {
 }
 
 void DirectoryStatsManager::setTagLibrary(TagLibrary::Library *const tagLibrary) {
+    if (tagLibrary_)
+        disconnect(tagLibrary_, &TagLibrary::Library::contentChanged, this, nullptr);
+
     tagLibrary_ = tagLibrary;
+    knownTagsStale_ = true;
+
+    if (tagLibrary_)
+        connect(tagLibrary_, &TagLibrary::Library::contentChanged, this, [this]{ knownTagsStale_ = true; });
 }
 
 DirectoryStats &DirectoryStatsManager::directoryStats(QString const &path) {
@@ -57,16 +64,77 @@ void DirectoryStatsManager::invalidateDirectoryStatsCache() {
 
     qDebug() << "Clearing directory stats cache";
 
-    QMutexLocker locker(&mutex_);
-    stats_.clear();
+    // Jobs refer to the stats they were started for, so none may outlive them. Queued ones are dropped, running ones
+    // stop at the next entry; without holding the locks, which they take.
+    threadPoolInterrupt_.test_and_set();
+    threadPool_.clear();
+    threadPool_.waitForDone();
+
+    {
+        QMutexLocker locker(&mutex_);
+        QMutexLocker aggregationLocker(&aggregationMutex_);
+        stats_.clear();
+    }
+
+    threadPoolInterrupt_.clear();
 
     qDebug() << "Clearing directory stats cache done";
 }
 
+void DirectoryStatsManager::reloadFile(QString const &path) {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(path).isAbsolute());
+
+    if (!project_ || !tagLibrary_)
+        return;
+
+    DirectoryStats *stats = nullptr;
+    {
+        QMutexLocker locker(&mutex_);
+        if (auto it = stats_.find(QFileInfo(path).path()); it != stats_.end())
+            stats = &*it->second;
+    }
+
+    if (stats)
+        stats->reloadFile(path);
+}
+
+void DirectoryStatsManager::reloadDirectory(QString const &path) {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(path).isAbsolute());
+
+    if (!project_ || !tagLibrary_)
+        return;
+
+    DirectoryStats *stats = nullptr;
+    {
+        QMutexLocker locker(&mutex_);
+        if (auto it = stats_.find(path); it != stats_.end())
+            stats = &*it->second;
+    }
+
+    if (stats)
+        stats->reload();
+}
+
 int DirectoryStatsManager::cachedDirectories() const {
     return stats_.size();
 }
 
-QStringList DirectoryStatsManager::knownTags() const {
-    return tagLibrary_->allTags();
+std::shared_ptr<DirectoryStatsManager::KnownTags const> DirectoryStatsManager::knownTags() const {
+    ZoneScoped;
+    gsl_Expects(tagLibrary_);
+
+    QMutexLocker locker(&knownTagsMutex_);
+
+    if (knownTagsStale_.exchange(false) || !knownTags_) {
+        auto allTags = tagLibrary_->allTags();
+
+        auto knownTags = std::make_shared<KnownTags>();
+        auto allTagIds = TagDictionary::instance().intern(allTags);
+        knownTags->tags = QSet<TagId>(allTagIds.begin(), allTagIds.end());
+        knownTags_ = std::move(knownTags);
+    }
+
+    return knownTags_;
 }
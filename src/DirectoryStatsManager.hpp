@@ -15,6 +15,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #pragma once
+#include "TagDictionary.hpp"
 
 class DirectoryStats;
 class FileTagsManager;
@@ -43,9 +44,20 @@ public:
 
     DirectoryStats &directoryStats(QString const &path);
     void invalidateDirectoryStatsCache();
+
+    // Incremental updates after changes on disk; directories without stats computed yet are left alone. A changed
+    // image is re-counted on its own, with the difference pushed up to the ancestors.
+    void reloadFile(QString const &path);
+    void reloadDirectory(QString const &path);
     int cachedDirectories() const;
 
-    QStringList knownTags() const;
+    // Immutable snapshot of all tags known to the tag library. It's shared between all stats reload workers and
+    // views, and is rebuilt lazily only after the tag library content changes.
+    struct KnownTags {
+        QSet<TagId> tags;
+    };
+
+    std::shared_ptr<KnownTags const> knownTags() const;
 
 signals:
     void directoryStatsChanged(QString const &path);
@@ -55,6 +67,13 @@ private:
     TagLibrary::Library *tagLibrary_ = nullptr;
     FileTagsManager &fileTagsManager_;
 
+    mutable QMutex knownTagsMutex_;
+    mutable std::shared_ptr<KnownTags const> knownTags_;
+    mutable std::atomic_bool knownTagsStale_ = true;
+
+    // guards aggregation state (parent/children links and totals) of all DirectoryStats
+    QMutex aggregationMutex_;
+
     QMutex mutex_;
     std::unordered_map<QString, std::unique_ptr<DirectoryStats>> stats_;
 
@@ -17,6 +17,7 @@
 #include "DirectoryTreeModel.hpp"
 
 #include "FileTagsManager.hpp"
+#include "Thumbnail.hpp"
 #include "Utility.hpp"
 #include "../CustomItemDataRole.hpp"
 #include "../DirectoryStats.hpp"
@@ -27,6 +28,26 @@ namespace FileBrowser {
 namespace {
     constexpr unsigned int ROW_HEIGHT = 80;
     constexpr unsigned int CACHE_QUALITY = 50;
+    constexpr qsizetype DEFAULT_THUMBNAIL_CACHE_CAPACITY = 256 * 1024 * 1024;
+    constexpr int THUMBNAIL_THREADS = 4;
+
+    QImage generateThumbnail(QString const &path, ThumbnailStore *const store) {
+        ZoneScoped;
+
+        QFileInfo sourceInfo{path};
+        if (store)
+            if (auto image = store->find(path, sourceInfo))
+                return *image;
+
+        qDebug() << "DirectoryTreeModel::generateThumbnail: Loading: " << path;
+        auto image = loadThumbnail(path, ROW_HEIGHT);
+
+        if (store && !image.isNull())
+            if (auto result = store->insert(path, sourceInfo, image); !result)
+                qWarning() << "DirectoryTreeModel::generateThumbnail: Could not store thumbnail: " << result.error();
+
+        return image;
+    }
 }
 
 // this provider never returns any correct icon. this accelerates the model a lot on slow disks (incl. preventing
@@ -77,9 +98,14 @@ DirectoryTreeModel::DirectoryTreeModel(
         isFileExcluded_{isFileExcluded},
         isOtherLibraryOrVersion_{isOtherLibraryOrVersion},
         directoryIcon{style->standardPixmap(QStyle::SP_DirIcon)},
-        cacheDir{QStandardPaths::standardLocations(QStandardPaths::StandardLocation::CacheLocation).at(0)+"/DirectoryTreeModelCache"} {
+        cacheDir{QStandardPaths::standardLocations(QStandardPaths::StandardLocation::CacheLocation).at(0)+"/DirectoryTreeModelCache"},
+        thumbnailCache_{DEFAULT_THUMBNAIL_CACHE_CAPACITY},
+        thumbnailPlaceholder_{static_cast<int>(ROW_HEIGHT), static_cast<int>(ROW_HEIGHT), QImage::Format::Format_ARGB32_Premultiplied} {
     ZoneScoped;
 
+    thumbnailPlaceholder_.fill(Qt::GlobalColor::transparent);
+    thumbnailThreadPool_.setMaxThreadCount(THUMBNAIL_THREADS);
+
     iconProvider = std::make_unique<CustomFileIconProvider>();
     setIconProvider(&*iconProvider);
 
@@ -96,9 +122,30 @@ DirectoryTreeModel::DirectoryTreeModel(
             },
             Qt::ConnectionType::QueuedConnection
     );
+
+    // rows of files whose tags weren't loaded yet are painted without them, repaint once they are
+    connect(&fileTagsManager, &FileTagsManager::fileTagsLoaded, this, [this](auto const &path){
+                ZoneScoped;
+                gsl_Expects(QFileInfo(path).isAbsolute());
+                if (auto idx = index(path); idx.isValid())
+                    emit dataChanged(idx, idx);
+            },
+            Qt::ConnectionType::QueuedConnection
+    );
+
+    connect(&fileTagsManager, &FileTagsManager::fileTagsInvalidated, this, [this](auto const &path){
+                ZoneScoped;
+                gsl_Expects(QFileInfo(path).isAbsolute());
+                if (auto idx = index(path); idx.isValid())
+                    emit dataChanged(idx, idx);
+            }
+    );
 }
 
-DirectoryTreeModel::~DirectoryTreeModel() = default;
+DirectoryTreeModel::~DirectoryTreeModel() {
+    // make queued thumbnail jobs return immediately, thread pool waits for the running ones
+    ++thumbnailGeneration_;
+}
 
 int DirectoryTreeModel::columnCount(const QModelIndex &) const {
     return 1;
@@ -135,10 +182,12 @@ QVariant DirectoryTreeModel::data(const QModelIndex &index, int role) const {
                 } else {
                     QString label = pathInfo.fileName() + "\n";
 
-                    if (auto fileTags = fileTagsManager_.forFile(path); !fileTags) {
+                    if (auto fileTags = fileTagsManager_.forFileIfLoaded(path); !fileTags) {
                         label += fileTags.error();
+                    } else if (!*fileTags) {
+                        label += tr("loading tags...");
                     } else {
-                        if (auto rect = fileTags->get().imageRegion()) {
+                        if (auto rect = (*fileTags)->imageRegion()) {
                             int w = rect->right() - rect->left();
                             int h = rect->bottom() - rect->top();
                             auto ar = toMinimalAspectRatio(QSize(w, h));
@@ -150,24 +199,27 @@ QVariant DirectoryTreeModel::data(const QModelIndex &index, int role) const {
                             label += "no assigned region\n";
 
                         static constexpr int maxTags = 5;
-                        if (fileTags->get().assignedTags().isEmpty())
+                        auto const &assignedTags = (*fileTags)->assignedTagIds();
+                        auto &dictionary = TagDictionary::instance();
+                        if (assignedTags.isEmpty())
                             label += "no assigned tags\n";
-                        else if (fileTags->get().assignedTags().size() <= maxTags)
-                            label += tr("%1 tag(s): %2\n", "", fileTags->get().assignedTags().size())
-                                    .arg(fileTags->get().assignedTags().size())
-                                    .arg(fileTags->get().assignedTags().join(", "));
+                        else if (assignedTags.size() <= maxTags)
+                            label += tr("%1 tag(s): %2\n", "", assignedTags.size())
+                                    .arg(assignedTags.size())
+                                    .arg(dictionary.tags(assignedTags).join(", "));
                         else
-                            label += tr("%1 tag(s): %2, ...\n", "", fileTags->get().assignedTags().size())
-                                    .arg(fileTags->get().assignedTags().size())
-                                    .arg(fileTags->get().assignedTags().sliced(0, maxTags).join(", "));
+                            label += tr("%1 tag(s): %2, ...\n", "", assignedTags.size())
+                                    .arg(assignedTags.size())
+                                    .arg(dictionary.tags(assignedTags.sliced(0, maxTags)).join(", "));
 
                         auto knownTags = directoryStatsManager_.knownTags();
-                        auto unknownTags =
-                                fileTags->get().assignedTags()
-                                | std::views::filter([&](auto const &tag){
-                                    return !knownTags.contains(tag);
+                        auto unknownTags = dictionary.tags(
+                                assignedTags
+                                | std::views::filter([&](auto const tag){
+                                    return !knownTags->tags.contains(tag);
                                 })
-                                | std::ranges::to<QStringList>();
+                                | std::ranges::to<TagIdList>()
+                        );
                         if (unknownTags.size() > 0) {
                             if (unknownTags.size() <= maxTags)
                                 label += tr("%1 unknown tag(s): %2\n", "", unknownTags.size())
@@ -179,7 +231,7 @@ QVariant DirectoryTreeModel::data(const QModelIndex &index, int role) const {
                                         .arg(unknownTags.sliced(0, maxTags).join(", "));
                         }
 
-                        if (isOtherLibraryOrVersion_(fileTags->get()))
+                        if (isOtherLibraryOrVersion_(**fileTags))
                             label += QString("Tagged with other tag library or version");
                     }
                     return label;
@@ -217,15 +269,15 @@ QVariant DirectoryTreeModel::data(const QModelIndex &index, int role) const {
                         brushes.emplace_back(Qt::GlobalColor::cyan, Qt::BrushStyle::FDiagPattern);
                     }
                 } else {
-                    if (auto tags = fileTagsManager_.forFile(path); !tags) {
+                    if (auto tags = fileTagsManager_.forFileIfLoaded(path); !tags) {
                         qWarning() << "Couldn't get tags for" << path << ":" << tags.error();
-                    } else {
-                        if (tags->get().isCompleteFlag())
+                    } else if (*tags) {
+                        if ((*tags)->isCompleteFlag())
                             brushes.emplace_back(QColor(0, 255, 0, 64), Qt::BrushStyle::SolidPattern);
-                        else if (tags->get().assignedTags().size() != 0)
+                        else if ((*tags)->assignedTagIds().size() != 0)
                             brushes.emplace_back(QColor(255, 255, 0, 64), Qt::BrushStyle::SolidPattern);
 
-                        if (isOtherLibraryOrVersion_(tags->get()))
+                        if (isOtherLibraryOrVersion_(**tags))
                             brushes.emplace_back(QColor(0, 0, 255, 128), Qt::BrushStyle::HorPattern);
                     }
                 }
@@ -266,36 +318,87 @@ void DirectoryTreeModel::refreshExcludedState(QString const &file) {
     emit dataChanged(idx, idx);
 }
 
+void DirectoryTreeModel::setProjectRootPath(QString const &projectRootPath) {
+    ZoneScoped;
+
+    auto rootHash = QCryptographicHash::hash(projectRootPath.toUtf8(), QCryptographicHash::Algorithm::Sha256);
+    auto storePath = QString("%1/%2.%3.%4").arg(
+            cacheDir, QString::fromLatin1(rootHash.toHex()), QString::number(ROW_HEIGHT), QString::number(CACHE_QUALITY)
+    );
+
+    // jobs already queued keep their reference to the previous store
+    thumbnailStore_.reset();
+    if (auto result = ThumbnailStore::create(projectRootPath, storePath, CACHE_QUALITY); !result)
+        qWarning() << "DirectoryTreeModel: could not open thumbnail store" << storePath << ":" << result.error();
+    else
+        thumbnailStore_ = std::move(*result);
+}
+
+void DirectoryTreeModel::setThumbnailCacheCapacity(qsizetype const capacityBytes) {
+    thumbnailCache_.setCapacity(capacityBytes);
+}
+
+ThumbnailCache::Counters DirectoryTreeModel::thumbnailCacheCounters() const {
+    return thumbnailCache_.counters();
+}
+
+void DirectoryTreeModel::invalidateThumbnail(QString const &path) {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(path).isAbsolute());
+
+    // the persistent store notices the change by itself, as it keys thumbnails by the state of the source file
+    thumbnailCache_.remove(path);
+
+    if (auto idx = index(path); idx.isValid())
+        emit dataChanged(idx, idx, {Qt::ItemDataRole::DecorationRole});
+}
+
+void DirectoryTreeModel::dropPendingThumbnails() {
+    ZoneScoped;
+
+    // jobs still in the queue will notice the generation change and return without decoding anything
+    ++thumbnailGeneration_;
+    pendingThumbnails_.clear();
+}
+
 QImage DirectoryTreeModel::getImage(QString const &path) const {
     ZoneScoped;
 
-    // TODO: clear cache if it becomes too huge
+    if (auto image = thumbnailCache_.find(path))
+        return *image;
 
-    auto it = imageCache.find(path);
-    if (it == imageCache.end()) {
-        auto cacheEntry = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Algorithm::Sha256);
-        auto cachePath = QString("%1/%2.%3.%4.jpg").arg(
-                cacheDir, QString::fromLatin1(cacheEntry.toHex()), QString::number(ROW_HEIGHT), QString::number(CACHE_QUALITY)
-        );
+    requestImage(path);
+    return thumbnailPlaceholder_;
+}
 
-        QFileInfo cachePathInfo{cachePath};
-        QImage image;
-        if (!cachePathInfo.exists()) {
-            qDebug() << "DirectoryTreeModel::getImage: Loading: " << path;
-            image = QImage{path};
+void DirectoryTreeModel::requestImage(QString const &path) const {
+    ZoneScoped;
 
-            qDebug() << "DirectoryTreeModel::getImage: Scaling to height " << ROW_HEIGHT;
-            image = image.scaledToHeight(ROW_HEIGHT, Qt::TransformationMode::SmoothTransformation);
+    if (pendingThumbnails_.contains(path))
+        return;
 
-            qDebug() << "DirectoryTreeModel::getImage: Saving: " << cachePath;
-            if (!image.save(cachePath, nullptr, CACHE_QUALITY))
-                qWarning() << "DirectoryTreeModel::getImage: Could not save cache file: " << cachePath;
-        } else
-            image = QImage{cachePath};
+    pendingThumbnails_.insert(path);
 
-        std::tie(it, std::ignore) = imageCache.emplace(path, image);
-    }
+    // data() is const, but delivering the result requires emitting signals
+    auto self = const_cast<DirectoryTreeModel *>(this);
+
+    thumbnailThreadPool_.start([self, path, store = thumbnailStore_, generation = thumbnailGeneration_.load()]{
+        ZoneScoped;
+
+        if (generation != self->thumbnailGeneration_.load())
+            return;
+
+        self->thumbnailCache_.insert(path, generateThumbnail(path, store.get()));
+
+        QMetaObject::invokeMethod(self, [self, path, generation]{
+            ZoneScoped;
+
+            if (generation == self->thumbnailGeneration_.load())
+                self->pendingThumbnails_.remove(path);
 
-    return it->second;
+            if (auto idx = self->index(path); idx.isValid())
+                emit self->dataChanged(idx, idx, {Qt::ItemDataRole::DecorationRole});
+        }, Qt::ConnectionType::QueuedConnection);
+    });
 }
 }
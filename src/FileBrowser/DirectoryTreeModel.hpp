@@ -18,6 +18,9 @@
 #include <QFileSystemModel>
 #include <QStyle>
 
+#include "ThumbnailCache.hpp"
+#include "ThumbnailStore.hpp"
+
 class DirectoryStatsManager;
 class FileTags;
 class FileTagsManager;
@@ -48,8 +51,22 @@ public:
 
     void refreshExcludedState(QString const &file);
 
+    // thumbnails are persisted in a store dedicated to the project root
+    void setProjectRootPath(QString const &projectRootPath);
+
+    void setThumbnailCacheCapacity(qsizetype capacityBytes);
+    [[nodiscard]] ThumbnailCache::Counters thumbnailCacheCounters() const;
+
+    // for images changed on disk
+    void invalidateThumbnail(QString const &path);
+
+    // drops all thumbnail requests that didn't start yet (e.g. rows scrolled out of view); views are expected to
+    // repaint afterwards, so that still visible rows request their thumbnails again
+    void dropPendingThumbnails();
+
 private:
     QImage getImage(QString const &path) const;
+    void requestImage(QString const &path) const;
 
     std::unique_ptr<CustomFileIconProvider> iconProvider;
 
@@ -60,6 +77,16 @@ private:
     IsOtherLibraryOrVersion isOtherLibraryOrVersion_;
     QPixmap directoryIcon;
     QString cacheDir;
-    mutable std::unordered_map<QString, QImage> imageCache;
+    mutable ThumbnailCache thumbnailCache_;
+    std::shared_ptr<ThumbnailStore> thumbnailStore_;
+    QImage thumbnailPlaceholder_;
+
+    // accessed only from the GUI thread
+    mutable QSet<QString> pendingThumbnails_;
+    // bumped to make queued thumbnail requests obsolete
+    std::atomic<quint64> thumbnailGeneration_ = 0;
+
+    // placed last, so that it's destroyed (and waits for running jobs) before everything the jobs use
+    mutable QThreadPool thumbnailThreadPool_;
 };
 }
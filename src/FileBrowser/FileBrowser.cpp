@@ -21,8 +21,10 @@
 #include "DirectoryTreeProxyModel.hpp"
 #include "Utility.hpp"
 
+#include "../Constants.hpp"
 #include "../DirectoryStats.hpp"
 #include "../DirectoryStatsManager.hpp"
+#include "../FileSystemWatcher.hpp"
 #include "../FileTagsManager.hpp"
 #include "../FileEditor.hpp"
 
@@ -57,7 +59,8 @@ FileBrowser::FileBrowser(
     )),
     directoryTreeProxyModel(std::make_unique<DirectoryTreeProxyModel>(
             [this](auto const &file) { return isFileExcludedAbsPath(file); }
-    )) {}
+    )),
+    fileSystemWatcher_(std::make_unique<FileSystemWatcher>()) {}
 
 std::expected<void, QString> FileBrowser::init() {
     ZoneScoped;
@@ -70,6 +73,25 @@ std::expected<void, QString> FileBrowser::init() {
 
     ui->comboBoxDirectories->setModel(&*projectDirectoryListModel);
 
+    connect(&*projectDirectoryListModel, &ProjectDirectoryListModel::modelReset, this, qOverload<>(&FileBrowser::watchDirectories));
+    connect(&*projectDirectoryListModel, &ProjectDirectoryListModel::rowsInserted, this, [this](
+            QModelIndex const &, int const first, int const last){
+        watchDirectories(first, last);
+    });
+    connect(&*projectDirectoryListModel, &ProjectDirectoryListModel::rowsAboutToBeRemoved, this, [this](
+            QModelIndex const &, int const first, int const last){
+        unwatchDirectories(first, last);
+    });
+
+    connect(&*fileSystemWatcher_, &FileSystemWatcher::filesChanged, this, &FileBrowser::filesChangedExternally);
+    connect(&*fileSystemWatcher_, &FileSystemWatcher::directoriesChanged, this, [this](QStringList const &paths){
+        ZoneScoped;
+        for (auto const &path: paths)
+            directoryStatsManager_.reloadDirectory(path);
+    });
+    // some changes were missed, so fall back to rescanning everything
+    connect(&*fileSystemWatcher_, &FileSystemWatcher::overflowed, ui->actionRefresh, &QAction::trigger);
+
     connect(&*projectDirectoryListModel, &ProjectDirectoryListModel::rowsInserted, this, [this](
             QModelIndex const &parent, int const first, int const last){
         ZoneScoped;
@@ -153,6 +175,13 @@ std::expected<void, QString> FileBrowser::init() {
     directoryTreeModel->setNameFilters(NAME_FILTERS);
     directoryTreeModel->setNameFilterDisables(false);
 
+    // thumbnails requested for rows that are no longer visible are dropped, repaint re-requests the visible ones
+    connect(ui->treeViewDirectories->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]{
+        ZoneScoped;
+        directoryTreeModel->dropPendingThumbnails();
+        ui->treeViewDirectories->viewport()->update();
+    });
+
     connect(ui->treeViewDirectories, &CustomTreeView::customContextMenuRequested, this, [this](auto const &pos){
         ZoneScoped;
 
@@ -264,6 +293,7 @@ void FileBrowser::setProjectRootPath(QString const &projectRootPath) {
     ZoneScoped;
     gsl_Expects(QFileInfo(projectRootPath).isDir());
     projectRootPath_ = projectRootPath;
+    directoryTreeModel->setProjectRootPath(projectRootPath);
 }
 
 void FileBrowser::setDirectories(QStringList const &directories) {
@@ -302,6 +332,49 @@ std::expected<void, QString> FileBrowser::selectFileInTree(QString const &file)
     return {};
 }
 
+QStringList FileBrowser::neighbourFiles(QString const &file, int const count) const {
+    ZoneScoped;
+    gsl_Expects(count >= 0);
+
+    QStringList result;
+    if (!directoryTreeProxyModel->sourceModel())
+        return result;
+
+    auto sourceIndex = directoryTreeModel->index(file);
+    if (!sourceIndex.isValid())
+        return result;
+
+    auto index = directoryTreeProxyModel->mapFromSource(sourceIndex);
+    if (!index.isValid())
+        return result;
+
+    auto parent = index.parent();
+    auto rows = directoryTreeProxyModel->rowCount(parent);
+
+    auto sourceAt = [&](int const row) {
+        return directoryTreeProxyModel->mapToSource(directoryTreeProxyModel->index(row, 0, parent));
+    };
+
+    // walks in one direction, skipping directories
+    auto next = [&](int row, int const step) -> std::optional<int> {
+        for (row += step; row >= 0 && row < rows; row += step)
+            if (!directoryTreeModel->isDir(sourceAt(row)))
+                return row;
+        return std::nullopt;
+    };
+
+    std::optional<int> forward = index.row();
+    std::optional<int> backward = index.row();
+    for (int i = 0; i != count && (forward || backward); ++i) {
+        if (forward && (forward = next(*forward, 1)))
+            result.append(directoryTreeModel->filePath(sourceAt(*forward)));
+        if (backward && (backward = next(*backward, -1)))
+            result.append(directoryTreeModel->filePath(sourceAt(*backward)));
+    }
+
+    return result;
+}
+
 QByteArray FileBrowser::saveUiState() const {
     ZoneScoped;
 
@@ -337,6 +410,90 @@ void FileBrowser::restoreUiState(QByteArray const &value) {
     byteArray.clear();
 }
 
+void FileBrowser::setThumbnailCacheCapacity(qsizetype const capacityBytes) {
+    directoryTreeModel->setThumbnailCacheCapacity(capacityBytes);
+}
+
+ThumbnailCache::Counters FileBrowser::thumbnailCacheCounters() const {
+    return directoryTreeModel->thumbnailCacheCounters();
+}
+
+void FileBrowser::watchDirectories() {
+    ZoneScoped;
+
+    fileSystemWatcher_->clear();
+    watchDirectories(0, gsl::narrow<int>(projectDirectoryListModel->directories().size()) - 1);
+}
+
+void FileBrowser::watchDirectories(int const first, int const last) {
+    ZoneScoped;
+
+    if (projectRootPath_.isEmpty())
+        return;
+
+    for (int row = first; row <= last; ++row) {
+        auto directory = absoluteDirectory(projectDirectoryListModel->directory(row));
+        if (auto result = fileSystemWatcher_->addDirectory(directory); !result)
+            qWarning() << "Changes in" << directory << "made by other programs won't be picked up:" << result.error();
+    }
+}
+
+void FileBrowser::unwatchDirectories(int const first, int const last) {
+    ZoneScoped;
+
+    if (projectRootPath_.isEmpty())
+        return;
+
+    // project directories might be nested, and a tree stays watched for as long as any directory covers it
+    QStringList remaining;
+    auto const &directories = projectDirectoryListModel->directories();
+    for (int row = 0; row != gsl::narrow<int>(directories.size()); ++row)
+        if (row < first || row > last)
+            remaining.append(absoluteDirectory(directories.at(row)));
+
+    auto isBelow = [](QString const &path, QString const &directory) {
+        return path == directory || path.startsWith(directory + "/");
+    };
+
+    for (int row = first; row <= last; ++row) {
+        auto directory = absoluteDirectory(projectDirectoryListModel->directory(row));
+        if (std::ranges::any_of(remaining, [&](auto const &other){ return isBelow(directory, other); }))
+            continue;
+
+        fileSystemWatcher_->removeDirectory(directory);
+
+        for (auto const &other: remaining)
+            if (isBelow(other, directory))
+                if (auto result = fileSystemWatcher_->addDirectory(other); !result)
+                    qWarning() << "Changes in" << other << "made by other programs won't be picked up:" << result.error();
+    }
+}
+
+QString FileBrowser::absoluteDirectory(QString const &directory) const {
+    return QDir::cleanPath(QDir(projectRootPath_).absoluteFilePath(directory));
+}
+
+void FileBrowser::filesChangedExternally(QStringList const &paths) {
+    ZoneScoped;
+
+    auto tagsFileSuffix = Constants::TAGS_FILE_SUFFIX.toString();
+
+    for (auto const &path: paths) {
+        if (path.endsWith(tagsFileSuffix)) {
+            // own saves are recognized by the manager; otherwise the tags file gets read once, by the stats update
+            auto imagePath = path.chopped(tagsFileSuffix.size());
+            if (fileTagsManager_.invalidate(imagePath))
+                directoryStatsManager_.reloadFile(imagePath);
+        } else if (QDir::match(NAME_FILTERS, QFileInfo(path).fileName())) {
+            // created, removed or rewritten image
+            if (!QFileInfo::exists(path))
+                fileTagsManager_.forget(path);
+            directoryTreeModel->invalidateThumbnail(path);
+            directoryStatsManager_.reloadFile(path);
+        }
+    }
+}
+
 void FileBrowser::openDirectory(QString const &directory) {
     ZoneScoped;
     gsl_Expects(!directory.isEmpty());
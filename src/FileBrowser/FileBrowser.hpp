@@ -15,12 +15,14 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #pragma once
+#include "ThumbnailCache.hpp"
 
 class Ui_FileBrowser;
 
 class DirectoryStatsManager;
 class DirectoryStats;
 class FileEditor;
+class FileSystemWatcher;
 class FileTags;
 class FileTagsManager;
 
@@ -69,9 +71,16 @@ public:
     [[nodiscard]] std::expected<void, QString> selectDirectoryInProjectList(QString const &directory);
     [[nodiscard]] std::expected<void, QString> selectFileInTree(QString const &file);
 
+    // files next to the given one, in the order shown in the tree, alternating next/previous starting from the
+    // closest ones; at most count files in each direction
+    [[nodiscard]] QStringList neighbourFiles(QString const &file, int count) const;
+
     [[nodiscard]] QByteArray saveUiState() const;
     void restoreUiState(QByteArray const &value);
 
+    void setThumbnailCacheCapacity(qsizetype capacityBytes);
+    [[nodiscard]] ThumbnailCache::Counters thumbnailCacheCounters() const;
+
 signals:
     void directoryAdded(QString const &directory);
     void directoryRemoved(QString const &directory);
@@ -85,6 +94,13 @@ private:
     void closeDirectory();
     void refreshDirectoryLabel();
 
+    // project directories are watched for changes made by other programs, so that they're picked up one file at a time
+    void watchDirectories();
+    void watchDirectories(int first, int last);
+    void unwatchDirectories(int first, int last);
+    [[nodiscard]] QString absoluteDirectory(QString const &directory) const;
+    void filesChangedExternally(QStringList const &paths);
+
     void fileSelectedHandle(QString const &path);
 
     bool isFileExcludedAbsPath(QString const &file);
@@ -98,6 +114,7 @@ private:
     std::unique_ptr<ProjectDirectoryListModel> projectDirectoryListModel;
     std::unique_ptr<DirectoryTreeModel> directoryTreeModel;
     std::unique_ptr<DirectoryTreeProxyModel> directoryTreeProxyModel;
+    std::unique_ptr<FileSystemWatcher> fileSystemWatcher_;
 
     QString projectRootPath_;
     QString currentDirectory_;
@@ -0,0 +1,53 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "Thumbnail.hpp"
+
+namespace FileBrowser {
+namespace {
+    // decode a bit bigger than requested, so that final smooth scaling still has some detail to work with
+    constexpr int DECODE_OVERSAMPLING = 2;
+}
+
+QImage loadThumbnail(QString const &path, int const height) {
+    ZoneScoped;
+    gsl_Expects(height > 0);
+
+    QImageReader reader(path);
+
+    auto decodeHeight = height * DECODE_OVERSAMPLING;
+    if (auto size = reader.size(); size.isValid() && size.height() > decodeHeight) {
+        auto decodeWidth = std::max<qint64>(1, static_cast<qint64>(size.width()) * decodeHeight / size.height());
+        reader.setScaledSize(QSize(static_cast<int>(decodeWidth), decodeHeight));
+    }
+
+    QImage image;
+    if (!reader.read(&image)) {
+        qWarning() << "loadThumbnail: reduced size decode of" << path << "failed:" << reader.errorString() << "; falling back to full decode";
+        return loadThumbnailFullDecode(path, height);
+    }
+
+    return image.scaledToHeight(height, Qt::TransformationMode::SmoothTransformation);
+}
+
+QImage loadThumbnailFullDecode(QString const &path, int const height) {
+    ZoneScoped;
+    gsl_Expects(height > 0);
+
+    QImage image{path};
+    return image.scaledToHeight(height, Qt::TransformationMode::SmoothTransformation);
+}
+}
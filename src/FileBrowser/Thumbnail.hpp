@@ -0,0 +1,26 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+namespace FileBrowser {
+// Loads image scaled to the given height. Where the image format supports it (e.g. JPEG DCT scaling), the image is
+// decoded directly at reduced size; falls back to full decode otherwise.
+QImage loadThumbnail(QString const &path, int height);
+
+// Reference implementation decoding the image in full resolution, kept for comparison in benchmarks.
+QImage loadThumbnailFullDecode(QString const &path, int height);
+}
@@ -0,0 +1,126 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "ThumbnailCache.hpp"
+
+namespace FileBrowser {
+namespace {
+    // rough per-entry bookkeeping overhead (list node, hash node, path string, QImage header)
+    constexpr qsizetype ENTRY_OVERHEAD = 256;
+}
+
+ThumbnailCache::ThumbnailCache(qsizetype const capacityBytes): capacityBytes_(capacityBytes) {
+    gsl_Expects(capacityBytes >= 0);
+}
+
+ThumbnailCache::~ThumbnailCache() = default;
+
+void ThumbnailCache::setCapacity(qsizetype const capacityBytes) {
+    ZoneScoped;
+    gsl_Expects(capacityBytes >= 0);
+
+    QMutexLocker locker(&mutex_);
+    capacityBytes_ = capacityBytes;
+    evict_();
+}
+
+std::optional<QImage> ThumbnailCache::find(QString const &path) {
+    ZoneScoped;
+
+    QMutexLocker locker(&mutex_);
+
+    auto it = index_.find(path);
+    if (it == index_.end()) {
+        ++misses_;
+        return std::nullopt;
+    }
+
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+}
+
+void ThumbnailCache::insert(QString const &path, QImage const &image) {
+    ZoneScoped;
+
+    QMutexLocker locker(&mutex_);
+
+    if (auto it = index_.find(path); it != index_.end()) {
+        bytes_ -= cost(it->second->second);
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    entries_.emplace_front(path, image);
+    index_.emplace(path, entries_.begin());
+    bytes_ += cost(image);
+
+    evict_();
+
+    gsl_Ensures(bytes_ >= 0);
+    gsl_Ensures(entries_.size() == index_.size());
+}
+
+void ThumbnailCache::remove(QString const &path) {
+    ZoneScoped;
+
+    QMutexLocker locker(&mutex_);
+
+    if (auto it = index_.find(path); it != index_.end()) {
+        bytes_ -= cost(it->second->second);
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+}
+
+void ThumbnailCache::clear() {
+    ZoneScoped;
+
+    QMutexLocker locker(&mutex_);
+    entries_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+ThumbnailCache::Counters ThumbnailCache::counters() const {
+    QMutexLocker locker(&mutex_);
+    return Counters{
+        .hits = hits_,
+        .misses = misses_,
+        .evictions = evictions_,
+        .entries = static_cast<qsizetype>(entries_.size()),
+        .bytes = bytes_,
+        .capacityBytes = capacityBytes_
+    };
+}
+
+qsizetype ThumbnailCache::cost(QImage const &image) {
+    return image.sizeInBytes() + ENTRY_OVERHEAD;
+}
+
+void ThumbnailCache::evict_() {
+    ZoneScoped;
+
+    // evict least recently used entries; a single entry bigger than the whole budget is dropped too
+    while (bytes_ > capacityBytes_ && !entries_.empty()) {
+        auto &[path, image] = entries_.back();
+        bytes_ -= cost(image);
+        index_.erase(path);
+        entries_.pop_back();
+        ++evictions_;
+    }
+}
+}
@@ -0,0 +1,65 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+namespace FileBrowser {
+// Thread-safe LRU cache of decoded thumbnails, bounded by total size of the images in bytes.
+class ThumbnailCache {
+public:
+    ThumbnailCache(ThumbnailCache const &other) = delete;
+    ThumbnailCache(ThumbnailCache &&other) = delete;
+    ThumbnailCache &operator=(ThumbnailCache const &other) = delete;
+    ThumbnailCache &operator=(ThumbnailCache &&other) = delete;
+
+    explicit ThumbnailCache(qsizetype capacityBytes);
+    ~ThumbnailCache();
+
+    struct Counters {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qsizetype entries = 0;
+        qsizetype bytes = 0;
+        qsizetype capacityBytes = 0;
+    };
+
+    void setCapacity(qsizetype capacityBytes);
+
+    [[nodiscard]] std::optional<QImage> find(QString const &path);
+    void insert(QString const &path, QImage const &image);
+    void remove(QString const &path);
+    void clear();
+
+    [[nodiscard]] Counters counters() const;
+
+private:
+    static qsizetype cost(QImage const &image);
+    void evict_();
+
+    mutable QMutex mutex_;
+    qsizetype capacityBytes_ = 0;
+    qsizetype bytes_ = 0;
+
+    // most recently used entries at the front
+    std::list<std::pair<QString, QImage>> entries_;
+    std::unordered_map<QString, decltype(entries_)::iterator> index_;
+
+    quint64 hits_ = 0;
+    quint64 misses_ = 0;
+    quint64 evictions_ = 0;
+};
+}
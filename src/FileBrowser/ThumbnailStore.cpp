@@ -0,0 +1,335 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "ThumbnailStore.hpp"
+
+namespace FileBrowser {
+namespace {
+    // both files start with a magic and a random generation; index is valid only for data file with the same
+    // generation, which protects against partially finished compaction
+    constexpr QByteArrayView DATA_MAGIC = "STTHMBD1";
+    constexpr QByteArrayView INDEX_MAGIC = "STTHMBI1";
+    constexpr qint64 HEADER_SIZE = 16;
+
+    // path hash (sha256) followed by source mtime, source size, offset and length (little-endian int64 each)
+    constexpr qint64 HASH_SIZE = 32;
+    constexpr qint64 RECORD_SIZE = HASH_SIZE + 4 * 8;
+
+    // compact when at least half of the data file is garbage, but don't bother for small files
+    constexpr qint64 COMPACTION_MIN_DEAD_BYTES = 4 * 1024 * 1024;
+
+    QByteArray header(QByteArrayView const magic, quint64 const generation) {
+        QByteArray result(magic.toByteArray());
+        result.resize(HEADER_SIZE);
+        qToLittleEndian(generation, result.data() + magic.size());
+        return result;
+    }
+
+    std::optional<quint64> parseHeader(QByteArrayView const data, QByteArrayView const magic) {
+        if (data.size() < HEADER_SIZE || !data.startsWith(magic))
+            return std::nullopt;
+        return qFromLittleEndian<quint64>(data.data() + magic.size());
+    }
+
+    QByteArray record(QByteArray const &hash, qint64 const sourceModified, qint64 const sourceSize, qint64 const offset, qint64 const length) {
+        gsl_Expects(hash.size() == HASH_SIZE);
+
+        QByteArray result(hash);
+        result.resize(RECORD_SIZE);
+        auto data = result.data() + HASH_SIZE;
+        for (auto const value: {sourceModified, sourceSize, offset, length}) {
+            qToLittleEndian(value, data);
+            data += sizeof(qint64);
+        }
+        return result;
+    }
+}
+
+ThumbnailStore::ThumbnailStore(QString const &rootDir, QString const &storeBasePath, int const quality):
+    rootDir_(rootDir),
+    dataFilePath_(storeBasePath + ".thumbdata"),
+    indexFilePath_(storeBasePath + ".thumbindex"),
+    quality_(quality) {}
+
+std::expected<void, QString> ThumbnailStore::init() {
+    ZoneScoped;
+
+    QMutexLocker locker(&mutex_);
+
+    if (auto result = open_(); !result) {
+        qWarning() << "ThumbnailStore: could not open" << dataFilePath_ << ":" << result.error() << "; starting over";
+        if (auto resetResult = reset_(); !resetResult)
+            return resetResult;
+    }
+
+    if (deadBytes_ >= COMPACTION_MIN_DEAD_BYTES && deadBytes_ >= liveBytes_) {
+        if (auto result = compact_(); !result) {
+            qWarning() << "ThumbnailStore: compaction of" << dataFilePath_ << "failed:" << result.error() << "; starting over";
+            if (auto resetResult = reset_(); !resetResult)
+                return resetResult;
+        }
+    }
+
+    return {};
+}
+
+std::expected<std::unique_ptr<ThumbnailStore>, QString> ThumbnailStore::create(
+        QString const &rootDir, QString const &storeBasePath, int const quality
+) {
+    ZoneScoped;
+
+    std::unique_ptr<ThumbnailStore> self{new ThumbnailStore(rootDir, storeBasePath, quality)};
+    if (auto result = self->init(); !result)
+        return std::unexpected(result.error());
+    else
+        return self;
+}
+
+ThumbnailStore::~ThumbnailStore() {
+    QMutexLocker locker(&mutex_);
+    close_();
+}
+
+std::optional<QImage> ThumbnailStore::find(QString const &path, QFileInfo const &sourceInfo) {
+    ZoneScoped;
+
+    auto hash = pathHash(path);
+
+    QByteArray data;
+    {
+        QMutexLocker locker(&mutex_);
+
+        auto it = records_.constFind(hash);
+        if (it == records_.cend()
+            || it->sourceModified != sourceInfo.lastModified().toMSecsSinceEpoch()
+            || it->sourceSize != sourceInfo.size())
+            return std::nullopt;
+
+        if (it->offset + it->length <= dataMapSize_) {
+            data = QByteArray(reinterpret_cast<char const *>(dataMap_ + it->offset), it->length);
+        } else {
+            // appended after the file was mapped
+            if (!dataFile_.seek(it->offset))
+                return std::nullopt;
+            data = dataFile_.read(it->length);
+        }
+    }
+
+    QImage image;
+    if (!image.loadFromData(data, "JPG")) {
+        qWarning() << "ThumbnailStore: could not decode stored thumbnail of" << path;
+        return std::nullopt;
+    }
+
+    return image;
+}
+
+std::expected<void, QString> ThumbnailStore::insert(QString const &path, QFileInfo const &sourceInfo, QImage const &image) {
+    ZoneScoped;
+
+    QByteArray data;
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        if (!image.save(&buffer, "JPG", quality_))
+            return std::unexpected(QObject::tr("Could not encode thumbnail of %1").arg(path));
+    }
+
+    auto hash = pathHash(path);
+    Record newRecord{
+        .sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch(),
+        .sourceSize = sourceInfo.size(),
+        .offset = 0,
+        .length = data.size()
+    };
+
+    QMutexLocker locker(&mutex_);
+
+    // data goes first, so that index never points past the end of data file
+    newRecord.offset = dataFile_.size();
+    if (!dataFile_.seek(newRecord.offset) || dataFile_.write(data) != data.size() || !dataFile_.flush())
+        return std::unexpected(QObject::tr("Could not write %1: %2").arg(dataFilePath_, dataFile_.errorString()));
+
+    auto indexRecord = record(hash, newRecord.sourceModified, newRecord.sourceSize, newRecord.offset, newRecord.length);
+    if (!indexFile_.seek(indexFile_.size()) || indexFile_.write(indexRecord) != indexRecord.size() || !indexFile_.flush())
+        return std::unexpected(QObject::tr("Could not write %1: %2").arg(indexFilePath_, indexFile_.errorString()));
+
+    if (auto it = records_.constFind(hash); it != records_.cend()) {
+        liveBytes_ -= it->length;
+        deadBytes_ += it->length;
+    }
+    liveBytes_ += newRecord.length;
+    records_.insert(hash, newRecord);
+
+    return {};
+}
+
+int ThumbnailStore::size() const {
+    QMutexLocker locker(&mutex_);
+    return records_.size();
+}
+
+std::expected<void, QString> ThumbnailStore::open_() {
+    ZoneScoped;
+
+    close_();
+
+    dataFile_.setFileName(dataFilePath_);
+    indexFile_.setFileName(indexFilePath_);
+
+    if (!dataFile_.exists() || !indexFile_.exists())
+        return reset_();
+
+    if (!dataFile_.open(QIODevice::ReadWrite))
+        return std::unexpected(QObject::tr("Could not open %1: %2").arg(dataFilePath_, dataFile_.errorString()));
+    if (!indexFile_.open(QIODevice::ReadWrite))
+        return std::unexpected(QObject::tr("Could not open %1: %2").arg(indexFilePath_, indexFile_.errorString()));
+
+    auto dataSize = dataFile_.size();
+    if (dataSize > 0)
+        dataMap_ = dataFile_.map(0, dataSize);
+    if (!dataMap_)
+        return std::unexpected(QObject::tr("Could not map %1: %2").arg(dataFilePath_, dataFile_.errorString()));
+    dataMapSize_ = dataSize;
+
+    auto dataGeneration = parseHeader(QByteArrayView(dataMap_, dataMapSize_), DATA_MAGIC);
+    if (!dataGeneration)
+        return std::unexpected(QObject::tr("Invalid header of %1").arg(dataFilePath_));
+
+    auto indexSize = indexFile_.size();
+    auto indexMap = indexSize > 0 ? indexFile_.map(0, indexSize) : nullptr;
+    if (!indexMap)
+        return std::unexpected(QObject::tr("Could not map %1: %2").arg(indexFilePath_, indexFile_.errorString()));
+    auto unmapIndex = std::experimental::scope_exit([&]{ indexFile_.unmap(indexMap); });
+
+    auto indexGeneration = parseHeader(QByteArrayView(indexMap, indexSize), INDEX_MAGIC);
+    if (!indexGeneration || *indexGeneration != *dataGeneration)
+        return std::unexpected(QObject::tr("Invalid header of %1").arg(indexFilePath_));
+
+    auto recordCount = (indexSize - HEADER_SIZE) / RECORD_SIZE;
+    for (qint64 i = 0; i < recordCount; ++i) {
+        auto data = indexMap + HEADER_SIZE + i * RECORD_SIZE;
+
+        QByteArray hash(reinterpret_cast<char const *>(data), HASH_SIZE);
+        Record newRecord{
+            .sourceModified = qFromLittleEndian<qint64>(data + HASH_SIZE),
+            .sourceSize = qFromLittleEndian<qint64>(data + HASH_SIZE + 8),
+            .offset = qFromLittleEndian<qint64>(data + HASH_SIZE + 16),
+            .length = qFromLittleEndian<qint64>(data + HASH_SIZE + 24)
+        };
+
+        if (newRecord.offset < HEADER_SIZE || newRecord.length <= 0 || newRecord.offset + newRecord.length > dataMapSize_) {
+            qWarning() << "ThumbnailStore: ignoring invalid record" << i << "in" << indexFilePath_;
+            continue;
+        }
+
+        if (auto it = records_.constFind(hash); it != records_.cend()) {
+            liveBytes_ -= it->length;
+            deadBytes_ += it->length;
+        }
+        liveBytes_ += newRecord.length;
+        records_.insert(hash, newRecord);
+    }
+
+    // drop partially written record (e.g. after a crash), so that new records stay aligned
+    if (auto validSize = HEADER_SIZE + recordCount * RECORD_SIZE; validSize != indexSize) {
+        unmapIndex.release();
+        indexFile_.unmap(indexMap);
+        if (!indexFile_.resize(validSize))
+            return std::unexpected(QObject::tr("Could not truncate %1: %2").arg(indexFilePath_, indexFile_.errorString()));
+    }
+
+    qDebug() << "ThumbnailStore: opened" << dataFilePath_ << "with" << records_.size() << "thumbnails," << liveBytes_ << "live bytes," << deadBytes_ << "dead bytes";
+    return {};
+}
+
+std::expected<void, QString> ThumbnailStore::reset_() {
+    ZoneScoped;
+
+    close_();
+
+    auto generation = QRandomGenerator::global()->generate64();
+
+    auto createFile = [&](QFile &file, QString const &path, QByteArrayView const magic)->std::expected<void, QString>{
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+            return std::unexpected(QObject::tr("Could not open %1: %2").arg(path, file.errorString()));
+        if (file.write(header(magic, generation)) != HEADER_SIZE || !file.flush())
+            return std::unexpected(QObject::tr("Could not write %1: %2").arg(path, file.errorString()));
+        return {};
+    };
+
+    if (auto result = createFile(dataFile_, dataFilePath_, DATA_MAGIC); !result)
+        return result;
+
+    if (auto result = createFile(indexFile_, indexFilePath_, INDEX_MAGIC); !result)
+        return result;
+
+    return {};
+}
+
+std::expected<void, QString> ThumbnailStore::compact_() {
+    ZoneScoped;
+
+    qDebug() << "ThumbnailStore: compacting" << dataFilePath_ << "(" << liveBytes_ << "live bytes," << deadBytes_ << "dead bytes)";
+
+    auto generation = QRandomGenerator::global()->generate64();
+
+    QSaveFile data(dataFilePath_);
+    QSaveFile index(indexFilePath_);
+    if (!data.open(QIODevice::WriteOnly) || !index.open(QIODevice::WriteOnly))
+        return std::unexpected(QObject::tr("Could not open files for compaction"));
+
+    data.write(header(DATA_MAGIC, generation));
+    index.write(header(INDEX_MAGIC, generation));
+
+    qint64 offset = HEADER_SIZE;
+    for (auto const &[hash, oldRecord]: records_.asKeyValueRange()) {
+        data.write(reinterpret_cast<char const *>(dataMap_ + oldRecord.offset), oldRecord.length);
+        index.write(record(hash, oldRecord.sourceModified, oldRecord.sourceSize, offset, oldRecord.length));
+        offset += oldRecord.length;
+    }
+
+    // data is committed first; in case index commit fails, generation mismatch invalidates the store
+    if (!data.commit())
+        return std::unexpected(QObject::tr("Could not write %1: %2").arg(dataFilePath_, data.errorString()));
+    if (!index.commit())
+        return std::unexpected(QObject::tr("Could not write %1: %2").arg(indexFilePath_, index.errorString()));
+
+    return open_();
+}
+
+void ThumbnailStore::close_() {
+    if (dataMap_) {
+        dataFile_.unmap(dataMap_);
+        dataMap_ = nullptr;
+        dataMapSize_ = 0;
+    }
+
+    dataFile_.close();
+    indexFile_.close();
+
+    records_.clear();
+    liveBytes_ = 0;
+    deadBytes_ = 0;
+}
+
+QByteArray ThumbnailStore::pathHash(QString const &path) const {
+    return QCryptographicHash::hash(
+            QDir(rootDir_).relativeFilePath(path).toUtf8(), QCryptographicHash::Algorithm::Sha256
+    );
+}
+}
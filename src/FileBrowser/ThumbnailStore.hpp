@@ -0,0 +1,76 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+namespace FileBrowser {
+// Persistent thumbnail storage for a single project root: one append-only data file with encoded thumbnails and one
+// index file of fixed-size records (path hash, source mtime/size, location in the data file). Superseded records are
+// dropped by compaction when the store is opened.
+class ThumbnailStore {
+    ThumbnailStore(QString const &rootDir, QString const &storeBasePath, int quality);
+    [[nodiscard]] std::expected<void, QString> init();
+
+public:
+    ThumbnailStore(ThumbnailStore const &other) = delete;
+    ThumbnailStore(ThumbnailStore &&other) = delete;
+    ThumbnailStore &operator=(ThumbnailStore const &other) = delete;
+    ThumbnailStore &operator=(ThumbnailStore &&other) = delete;
+
+    // storeBasePath gets suffixes appended for data and index files
+    [[nodiscard]] static std::expected<std::unique_ptr<ThumbnailStore>, QString> create(
+            QString const &rootDir, QString const &storeBasePath, int quality
+    );
+    ~ThumbnailStore();
+
+    // all methods below are thread-safe
+
+    // returns thumbnail only if it was generated from the source file in its current state
+    [[nodiscard]] std::optional<QImage> find(QString const &path, QFileInfo const &sourceInfo);
+    [[nodiscard]] std::expected<void, QString> insert(QString const &path, QFileInfo const &sourceInfo, QImage const &image);
+
+    [[nodiscard]] int size() const;
+
+private:
+    struct Record {
+        qint64 sourceModified = 0;
+        qint64 sourceSize = 0;
+        qint64 offset = 0;
+        qint64 length = 0;
+    };
+
+    [[nodiscard]] std::expected<void, QString> open_();
+    [[nodiscard]] std::expected<void, QString> reset_();
+    [[nodiscard]] std::expected<void, QString> compact_();
+    void close_();
+    [[nodiscard]] QByteArray pathHash(QString const &path) const;
+
+    QString rootDir_;
+    QString dataFilePath_;
+    QString indexFilePath_;
+    int quality_ = -1;
+
+    mutable QMutex mutex_;
+    QFile dataFile_;
+    QFile indexFile_;
+    uchar *dataMap_ = nullptr;
+    qint64 dataMapSize_ = 0;
+
+    QHash<QByteArray, Record> records_;
+    qint64 liveBytes_ = 0;
+    qint64 deadBytes_ = 0;
+};
+}
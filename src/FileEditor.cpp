@@ -25,6 +25,14 @@ FileEditor::FileEditor(FileTagsManager &fileTagsManager): fileTagsManager(fileTa
         if (imageFilePath == currentFile_)
             emit modifiedStateChanged(modified);
     });
+
+    // the open file's tags are reloaded in place when changed on disk by someone else
+    connect(&fileTagsManager, &FileTagsManager::fileTagsInvalidated, this, [this](QString const &imageFilePath){
+        if (imageFilePath == currentFile_) {
+            emit tagsChanged();
+            emit imageRegionChanged();
+        }
+    });
 }
 
 FileEditor::~FileEditor() = default;
@@ -73,7 +81,7 @@ std::expected<void, ErrorOrCancel> FileEditor::setFile(QString const &file) {
             else
                 fileTags = *result;
 
-            emit modifiedStateChanged(fileTags->get().isModified());
+            emit modifiedStateChanged(fileTags->isModified());
         }
 
         emit tagsChanged();
@@ -88,7 +96,7 @@ std::expected<void, ErrorOrCancel> FileEditor::resetFile() {
     ZoneScoped;
 
     if (!currentFile_.isEmpty()) {
-        if (fileTags && fileTags->get().isModified()) {
+        if (fileTags && fileTags->isModified()) {
             switch (QMessageBox::question(
                     qApp->activeWindow(), tr("Unsaved changes"), tr("Save changes in tags data?"),
                     QMessageBox::StandardButtons(
@@ -98,11 +106,11 @@ std::expected<void, ErrorOrCancel> FileEditor::resetFile() {
                     )
             )) {
                 case QMessageBox::StandardButton::Yes:
-                    if (auto result = fileTags->get().save(); !result)
+                    if (auto result = fileTags->save(); !result)
                         return std::unexpected(result.error());
                     break;
                 case QMessageBox::StandardButton::No:
-                    if (auto result = fileTags->get().rollbackChanges(); !result)
+                    if (auto result = fileTags->rollbackChanges(); !result)
                         return std::unexpected(result.error());
                     break;
                 case QMessageBox::StandardButton::Cancel:
@@ -124,68 +132,82 @@ std::expected<void, ErrorOrCancel> FileEditor::resetFile() {
     return {};
 }
 
+bool FileEditor::hasFile() const {
+    return static_cast<bool>(fileTags);
+}
+
 std::optional<bool> FileEditor::isTagged(QString const &tag) const {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    return assignedTags().transform([&](auto const &tags){ return tags.contains(tag); });
+    if (!fileTags)
+        return std::nullopt;
+
+    auto id = TagDictionary::instance().find(tag);
+    return id && assignedTagIds().contains(*id);
 }
 
 void FileEditor::setTagged(QStringList const &tags, bool const value) {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    if (fileTags && fileTags->get().setTags(tags, value))
+    if (fileTags && fileTags->setTags(tags, value))
         emit tagsChanged();
 }
 
 void FileEditor::setTagsState(std::unordered_map<QString, bool> const &state) {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    if (fileTags && fileTags->get().setTagsState(state))
+    if (fileTags && fileTags->setTagsState(state))
         emit tagsChanged();
 }
 
 void FileEditor::clearTags() {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    if (fileTags.transform([&](auto &f){ return f.get().clearTags(); }).value_or(false))
+    if (fileTags && fileTags->clearTags())
         emit tagsChanged();
 }
 
 std::optional<QStringList> FileEditor::assignedTags() const {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    return fileTags.transform([](auto const &v){ return v.get().assignedTags(); });
+    return fileTags ? std::optional(fileTags->assignedTags()) : std::nullopt;
+}
+
+TagIdList const &FileEditor::assignedTagIds() const {
+    ZoneScoped;
+    gsl_Expects(fileTags);
+    return fileTags->assignedTagIds();
 }
 
 std::expected<bool, QString> FileEditor::moveAssignedTag(int const sourcePositon, int const targetPosition) {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    return fileTags.transform([&](auto &v){ return v.get().moveAssignedTag(sourcePositon, targetPosition); }).value_or(false);
+    return fileTags && fileTags->moveAssignedTag(sourcePositon, targetPosition);
 }
 
 void FileEditor::setImageRegion(std::optional<QRect> const &rect) {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    if (fileTags.transform([&](auto &v){ return v.get().setImageRegion(rect); }).value_or(false))
+    if (fileTags && fileTags->setImageRegion(rect))
         emit imageRegionChanged();
 }
 
 std::optional<QRect> FileEditor::imageRegion() const {
     ZoneScoped;
     // TODO: gsl_Expects(fileTags); and direct access below
-    return fileTags.and_then([&](auto const &v){ return v.get().imageRegion(); });
+    return fileTags ? fileTags->imageRegion() : std::nullopt;
 }
 
 bool FileEditor::setCompleteFlag(bool const complete) {
     ZoneScoped;
     gsl_Expects(fileTags);
-    return fileTags->get().setCompleteFlag(complete);
+    return fileTags->setCompleteFlag(complete);
 }
 
 bool FileEditor::isCompleteFlag() const {
     ZoneScoped;
     gsl_Expects(fileTags);
-    return fileTags->get().isCompleteFlag();
+    return fileTags->isCompleteFlag();
 }
 
 std::expected<void, QString> FileEditor::setFileExcluded(bool const excluded) {
@@ -221,23 +243,23 @@ std::expected<void, Error> FileEditor::setFileExcluded(bool const excluded, QStr
 std::optional<QUuid> FileEditor::imageTagLibraryUuid() const {
     ZoneScoped;
     gsl_Expects(fileTags);
-    return fileTags->get().tagLibraryUuid();
+    return fileTags->tagLibraryUuid();
 }
 
 std::optional<int> FileEditor::imageTagLibraryVersion() const {
     ZoneScoped;
     gsl_Expects(fileTags);
-    return fileTags->get().tagLibraryVersion();
+    return fileTags->tagLibraryVersion();
 }
 
 std::optional<QUuid> FileEditor::imageTagLibraryVersionUuid() const {
     ZoneScoped;
     gsl_Expects(fileTags);
-    return fileTags->get().tagLibraryVersionUuid();
+    return fileTags->tagLibraryVersionUuid();
 }
 
 std::expected<void, QString> FileEditor::save() const {
     ZoneScoped;
     gsl_Expects(fileTags);
-    return fileTags->get().save();
+    return fileTags->save();
 }
@@ -15,6 +15,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #pragma once
+#include "TagDictionary.hpp"
 #include "Utility.hpp"
 
 class FileTags;
@@ -41,6 +42,7 @@ public:
 
     [[nodiscard]] std::expected<void, ErrorOrCancel> setFile(QString const &file);
     [[nodiscard]] std::expected<void, ErrorOrCancel> resetFile();
+    [[nodiscard]] bool hasFile() const;
 
     [[nodiscard]] std::optional<bool> isTagged(QString const &tag) const;
     void setTagged(QStringList const &tag, bool const value);
@@ -48,6 +50,7 @@ public:
     void clearTags();
 
     [[nodiscard]] std::optional<QStringList> assignedTags() const;
+    [[nodiscard]] TagIdList const &assignedTagIds() const;
     [[nodiscard]] std::expected<bool, QString> moveAssignedTag(int sourcePositon, int targetPosition);
 
     void setImageRegion(std::optional<QRect> const &rect);
@@ -80,7 +83,7 @@ private:
     QString currentFile_;
 
     FileTagsManager &fileTagsManager;
-    std::optional<std::reference_wrapper<FileTags>> fileTags;
+    std::shared_ptr<FileTags> fileTags;
 
     bool backupOnEverySave_ = false;
 };
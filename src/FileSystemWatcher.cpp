@@ -0,0 +1,224 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "FileSystemWatcher.hpp"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    // a tool rewriting a tags file usually produces a burst of events (create, write, rename); wait for it to settle
+    constexpr int DEBOUNCE_MS = 200;
+    // but don't let a continuous stream of events postpone the batch forever
+    constexpr qint64 MAX_DELAY_MS = 2000;
+
+    // file content is only looked at once it's complete, hence IN_CLOSE_WRITE rather than IN_MODIFY
+    constexpr std::uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+}
+
+FileSystemWatcher::FileSystemWatcher() {
+    // NOTE: this is linux specific!
+
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        qWarning() << "FileSystemWatcher: could not initialize inotify:" << qt_error_string(errno);
+    } else {
+        notifier_ = std::make_unique<QSocketNotifier>(fd_, QSocketNotifier::Type::Read);
+        connect(&*notifier_, &QSocketNotifier::activated, this, &FileSystemWatcher::readEvents);
+    }
+
+    debounceTimer_.setSingleShot(true);
+    debounceTimer_.setInterval(DEBOUNCE_MS);
+    connect(&debounceTimer_, &QTimer::timeout, this, &FileSystemWatcher::flush);
+
+    // one at a time, listings are I/O bound
+    walkThreadPool_.setMaxThreadCount(1);
+}
+
+FileSystemWatcher::~FileSystemWatcher() {
+    walkThreadPool_.clear();
+    walkThreadPool_.waitForDone();
+
+    notifier_.reset();
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+std::expected<void, QString> FileSystemWatcher::addDirectory(QString const &path) {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(path).isAbsolute());
+
+    if (fd_ < 0)
+        return std::unexpected(tr("File system watching is not available"));
+
+    return addTree_(path);
+}
+
+void FileSystemWatcher::removeDirectory(QString const &path) {
+    ZoneScoped;
+
+    auto prefix = path + "/";
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        if (it->first == path || it->first.startsWith(prefix)) {
+            ::inotify_rm_watch(fd_, it->second);
+            paths_.erase(it->second);
+            it = watches_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileSystemWatcher::clear() {
+    ZoneScoped;
+
+    for (auto const &[wd, path]: paths_)
+        ::inotify_rm_watch(fd_, wd);
+
+    paths_.clear();
+    watches_.clear();
+    ++generation_;
+
+    changedFiles_.clear();
+    changedDirectories_.clear();
+    debounceTimer_.stop();
+}
+
+std::expected<void, QString> FileSystemWatcher::addTree_(QString const &path) {
+    ZoneScoped;
+
+    if (auto result = addWatch_(path); !result)
+        return result;
+
+    walkThreadPool_.start([this, path, generation = generation_]{
+        ZoneScoped;
+
+        QStringList subdirectories;
+        QDirIterator iterator(path, QDir::Filter::Dirs | QDir::Filter::NoDotAndDotDot, QDirIterator::IteratorFlag::Subdirectories);
+        while (iterator.hasNext())
+            subdirectories.append(iterator.next());
+
+        QMetaObject::invokeMethod(this, [this, path, generation, subdirectories = std::move(subdirectories)]{
+            ZoneScoped;
+
+            // cleared or removed in the meantime
+            if (generation != generation_ || !watches_.contains(path))
+                return;
+
+            for (auto const &subdirectory: subdirectories) {
+                // most likely the fs.inotify.max_user_watches limit; changes in this directory will go unnoticed
+                if (auto result = addWatch_(subdirectory); !result)
+                    qWarning() << "FileSystemWatcher:" << result.error();
+            }
+        }, Qt::ConnectionType::QueuedConnection);
+    });
+
+    return {};
+}
+
+std::expected<void, QString> FileSystemWatcher::addWatch_(QString const &path) {
+    auto wd = ::inotify_add_watch(fd_, QFile::encodeName(path).constData(), WATCH_MASK);
+    if (wd < 0)
+        return std::unexpected(tr("Could not watch %1: %2").arg(path, qt_error_string(errno)));
+
+    paths_.insert_or_assign(wd, path);
+    watches_.insert_or_assign(path, wd);
+    return {};
+}
+
+void FileSystemWatcher::readEvents() {
+    ZoneScoped;
+
+    bool overflow = false;
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+        auto length = ::read(fd_, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (auto pointer = buffer; pointer < buffer + length;) {
+            auto const *event = reinterpret_cast<inotify_event const *>(pointer);
+            pointer += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+
+            auto it = paths_.find(event->wd);
+            if (it == paths_.end())
+                continue;
+
+            // the watched directory itself is gone; the event about it comes from its parent
+            if (event->mask & IN_IGNORED) {
+                // the path might be watched again already, under a new descriptor
+                if (auto watch = watches_.find(it->second); watch != watches_.end() && watch->second == event->wd)
+                    watches_.erase(watch);
+                paths_.erase(it);
+                continue;
+            }
+
+            if (event->len == 0)
+                continue;
+
+            auto directory = it->second;
+            auto path = QDir(directory).filePath(QFile::decodeName(event->name));
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    // subdirectories might have been created before the watch was, so add them all
+                    if (auto result = addTree_(path); !result)
+                        qWarning() << "FileSystemWatcher:" << result.error();
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    removeDirectory(path);
+                }
+                changedDirectories_.insert(directory);
+            } else {
+                changedFiles_.insert(path);
+            }
+        }
+    }
+
+    if (overflow) {
+        qWarning() << "FileSystemWatcher: event queue overflowed";
+        changedFiles_.clear();
+        changedDirectories_.clear();
+        debounceTimer_.stop();
+        emit overflowed();
+        return;
+    }
+
+    if (changedFiles_.empty() && changedDirectories_.empty())
+        return;
+
+    if (!debounceTimer_.isActive())
+        pendingSince_.start();
+    if (pendingSince_.elapsed() < MAX_DELAY_MS)
+        debounceTimer_.start();
+}
+
+void FileSystemWatcher::flush() {
+    ZoneScoped;
+
+    auto directories = std::exchange(changedDirectories_, {});
+    auto files = std::exchange(changedFiles_, {});
+
+    if (!directories.empty())
+        emit directoriesChanged(directories.values());
+    if (!files.empty())
+        emit filesChanged(files.values());
+}
@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+class QSocketNotifier;
+
+// Watches directory trees for changes made by other programs, using Linux inotify. Events are coalesced per path and
+// reported in batches, once the trees were quiet for a moment. Lives in, and is used from, the GUI thread; only the
+// subdirectories of added trees are listed on a worker.
+class FileSystemWatcher: public QObject {
+    Q_OBJECT
+
+public:
+    FileSystemWatcher(FileSystemWatcher const &other) = delete;
+    FileSystemWatcher(FileSystemWatcher &&other) = delete;
+    FileSystemWatcher &operator=(FileSystemWatcher const &other) = delete;
+    FileSystemWatcher &operator=(FileSystemWatcher &&other) = delete;
+
+    FileSystemWatcher();
+    ~FileSystemWatcher() override;
+
+    // watches the directory and all its subdirectories, including the ones created later
+    [[nodiscard]] std::expected<void, QString> addDirectory(QString const &path);
+    void removeDirectory(QString const &path);
+    void clear();
+
+signals:
+    // files written, created, removed or renamed
+    void filesChanged(QStringList const &paths);
+    // directories whose subdirectories were created, removed or renamed
+    void directoriesChanged(QStringList const &paths);
+    // the kernel dropped events, anything in the watched trees might have changed
+    void overflowed();
+
+private:
+    // the directory is watched right away, its subdirectories once a worker has listed them
+    [[nodiscard]] std::expected<void, QString> addTree_(QString const &path);
+    [[nodiscard]] std::expected<void, QString> addWatch_(QString const &path);
+    void readEvents();
+    void flush();
+
+    int fd_ = -1;
+    std::unique_ptr<QSocketNotifier> notifier_;
+
+    std::unordered_map<int, QString> paths_;
+    std::unordered_map<QString, int> watches_;
+
+    // coalesced until the next flush
+    QSet<QString> changedFiles_;
+    QSet<QString> changedDirectories_;
+    QTimer debounceTimer_;
+    QElapsedTimer pendingSince_;
+
+    // bumped by clear(), so that subdirectories listed before aren't watched
+    int generation_ = 0;
+    // last, so that no listing outlives the rest
+    QThreadPool walkThreadPool_;
+};
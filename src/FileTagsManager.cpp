@@ -26,6 +26,9 @@ namespace {
     // TODO: FileBrowser.cpp and DirectoryStats.cpp has a similar list (just with wildcards added), merge?
     const QStringList IMAGE_FILE_SUFFIXES = {".jpg", ".png"};
 
+    // loads started by forFileIfLoaded(); tags files are small, so this is mostly about waiting for the disk
+    constexpr int LOAD_THREADS = 4;
+
     enum class Key {
         FORMAT_VERSION = 1,
         APP = 2,
@@ -37,6 +40,15 @@ namespace {
         TAG_LIBRARY_VERSION_UUID = 8
     };
 
+    // the same signature as the project index uses
+    qint64 fileModified(QFileInfo const &fileInfo) {
+        return fileInfo.exists() ? fileInfo.lastModified().toMSecsSinceEpoch() : -1;
+    }
+
+    qint64 fileSize(QFileInfo const &fileInfo) {
+        return fileInfo.exists() ? fileInfo.size() : -1;
+    }
+
     constexpr int valueFormatVersion = 1;
     constexpr QAnyStringView valueApp = "SIMPLETAGGER-CXX";
 
@@ -111,6 +123,10 @@ FileTags::~FileTags() = default;
 QStringList FileTags::assignedTags() const {
     ZoneScoped;
 
+    return TagDictionary::instance().tags(assignedTags_);
+}
+
+TagIdList const &FileTags::assignedTagIds() const {
     return assignedTags_;
 }
 
@@ -147,10 +163,11 @@ bool FileTags::setTagsState(std::unordered_map<QString, bool> const &state) {
 bool FileTags::overwriteAssignedTags(QStringList const &activeTags) {
     ZoneScoped;
 
-    if (assignedTags_ == activeTags) {
+    auto activeTagIds = TagDictionary::instance().intern(activeTags);
+    if (assignedTags_ == activeTagIds) {
         return false;
     } else {
-        assignedTags_ = activeTags;
+        assignedTags_ = std::move(activeTagIds);
         setModified_(true);
         return true;
     }
@@ -187,11 +204,12 @@ bool FileTags::clearTags() {
 bool FileTags::setTag_(const QString &tag, bool value) {
     ZoneScoped;
 
-    if (value != assignedTags_.contains(tag)) {
+    auto id = TagDictionary::instance().intern(tag);
+    if (value != assignedTags_.contains(id)) {
         if (value)
-            assignedTags_.append(tag);
+            assignedTags_.append(id);
         else
-            assignedTags_.removeAll(tag);
+            assignedTags_.removeAll(id);
 
         return true;
     }
@@ -253,9 +271,17 @@ std::expected<void, QString> FileTags::rollbackChanges() {
     return load();
 }
 
+bool FileTags::isTagsFileChanged() const {
+    QFileInfo tagsFileInfo{tagsFilePath_};
+    return fileModified(tagsFileInfo) != tagsFileModified_ || fileSize(tagsFileInfo) != tagsFileSize_;
+}
+
 std::expected<void, QString> FileTags::load() {
     ZoneScoped;
 
+    // a rollback right after a save must see the saved state, not the one the queued write is about to replace
+    manager_.waitForSave(imageFilePath_);
+
     assignedTags_.clear();
     imageRegion_.reset();
     completeFlag_ = false;
@@ -265,7 +291,24 @@ std::expected<void, QString> FileTags::load() {
 
     setModified_(false);
 
-    if (QFileInfo{tagsFilePath_}.exists()) {
+    QFileInfo tagsFileInfo{tagsFilePath_};
+    tagsFileModified_ = fileModified(tagsFileInfo);
+    tagsFileSize_ = fileSize(tagsFileInfo);
+
+    auto projectIndex = manager_.projectIndex();
+    if (projectIndex) {
+        if (auto entry = projectIndex->find(imageFilePath_, tagsFileInfo)) {
+            assignedTags_ = std::move(entry->assignedTags);
+            imageRegion_ = entry->imageRegion;
+            completeFlag_ = entry->completeFlag;
+            tagLibraryUuid_ = entry->tagLibraryUuid;
+            tagLibraryVersion_ = entry->tagLibraryVersion;
+            tagLibraryVersionUuid_ = entry->tagLibraryVersionUuid;
+            return {};
+        }
+    }
+
+    if (tagsFileInfo.exists()) {
         qDebug() << "Loading tags from" << tagsFilePath_;
 
         auto res = loadTagsFile(tagsFilePath_);
@@ -281,7 +324,7 @@ std::expected<void, QString> FileTags::load() {
                     if (!tag.isString())
                         return std::unexpected(QObject::tr("Tag %1 is not a string, but ").arg(cborTypeToString(tag.type())));
                     else
-                        assignedTags_.append(tag.toString());
+                        assignedTags_.append(TagDictionary::instance().intern(tag.toString()));
                 }
             }
         }
@@ -332,6 +375,9 @@ std::expected<void, QString> FileTags::load() {
         qDebug() << "Loading tags from" << tagsFilePath_<< ": done";
     }
 
+    if (projectIndex)
+        projectIndex->update(imageFilePath_, tagsFileInfo, toIndexEntry());
+
     return {};
 }
 
@@ -345,38 +391,11 @@ std::expected<void, QString> FileTags::save(bool const forceSave, bool const for
     if (!forceSave && !modified_)
         return {};
 
-    bool backup = forceBackup || backupOnSave_;
-
-    if (!backup) {
-        // First, open the original file, to see whether it can be opened without warnings. In case there were warnings,
-        // we first backup the original file
-        QFileInfo tagsFileInfo{tagsFilePath_};
-
-        if (tagsFileInfo.exists()) {
-            auto res = loadTagsFile(tagsFilePath_);
-            backup = backup || !res.has_value() || res->warningsOccurred;
-        }
-    }
-
-    std::optional<int> backupCount;
-
-    if (backup)
-        backupCount = backupFile(tagsFilePath_);
-
-    QElapsedTimer saveTimer;
-    saveTimer.start();
-
-    qDebug() << "Saving tags to" << tagsFilePath_;
-
-    QSaveFile saveFile{tagsFilePath_};
-    if (!saveFile.open(QIODevice::WriteOnly))
-        return std::unexpected(QObject::tr("Could not open %1 for writing: %2").arg(tagsFilePath_).arg(saveFile.errorString()));
-
     QCborMap map;
     map[std::to_underlying(Key::FORMAT_VERSION)] = valueFormatVersion;
     map[std::to_underlying(Key::APP)] = valueApp.toString();
 
-    map[std::to_underlying(Key::TAGS)] = assignedTags_ | std::ranges::to<QCborArray>();
+    map[std::to_underlying(Key::TAGS)] = TagDictionary::instance().tags(assignedTags_) | std::ranges::to<QCborArray>();
 
     if (imageRegion_)
         map[std::to_underlying(Key::REGION)] = QCborArray({
@@ -390,18 +409,21 @@ std::expected<void, QString> FileTags::save(bool const forceSave, bool const for
     map[std::to_underlying(Key::TAG_LIBRARY_VERSION)] = *tagLibraryVersion_;
     map[std::to_underlying(Key::TAG_LIBRARY_VERSION_UUID)] = tagLibraryVersionUuid_->toRfc4122();
 
-    QCborStreamWriter writer(&saveFile);
-    map.toCborValue().toCbor(writer);
-
-    qDebug() << "Preparatory saving time:" << saveTimer.elapsed() << "ms";
+    // the tags are only ever created by the manager, which owns them through a shared_ptr
+    auto self = weak_from_this().lock();
+    gsl_Assert(self);
 
-    if (!saveFile.commit())
-        return std::unexpected(QObject::tr("Failed to write file %1: %2").arg(tagsFilePath_).arg(saveFile.errorString()));
+    manager_.enqueueSave(FileTagsManager::SaveRequest{
+        .fileTags = std::move(self),
+        .imageFilePath = imageFilePath_,
+        .tagsFilePath = tagsFilePath_,
+        .backup = forceBackup || backupOnSave_,
+        .content = map.toCborValue().toCbor(),
+        .projectIndex = manager_.projectIndex(),
+        .indexEntry = toIndexEntry()
+    });
 
     setModified_(false);
-
-    qDebug() << "Total saving time:" << saveTimer.elapsed() << "ms";
-    emit manager_.tagsSaved(backupCount);
     return {};
 }
 
@@ -410,9 +432,31 @@ void FileTags::setModified_(bool const modified) {
     emit manager_.modifiedStateChanged(imageFilePath_, modified);
 }
 
-FileTagsManager::FileTagsManager(bool const backupOnSave): backupOnSave_(backupOnSave) {}
+ProjectIndex::Entry FileTags::toIndexEntry() const {
+    ProjectIndex::Entry entry;
+    entry.assignedTags = assignedTags_;
+    entry.imageRegion = imageRegion_;
+    entry.completeFlag = completeFlag_;
+    entry.tagLibraryUuid = tagLibraryUuid_;
+    entry.tagLibraryVersion = tagLibraryVersion_;
+    entry.tagLibraryVersionUuid = tagLibraryVersionUuid_;
+    return entry;
+}
 
-FileTagsManager::~FileTagsManager() = default;
+FileTagsManager::FileTagsManager(bool const backupOnSave): backupOnSave_(backupOnSave) {
+    threadPool_.setMaxThreadCount(LOAD_THREADS);
+    saveThreadPool_.setMaxThreadCount(1);
+}
+
+FileTagsManager::~FileTagsManager() {
+    // queued saves are written no matter what; nobody is left to be told about them, so the results and the tags they
+    // pin are dropped
+    saveThreadPool_.waitForDone();
+    QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+
+    // loads nobody waits for yet; the running ones are waited for by the thread pool
+    threadPool_.clear();
+}
 
 void FileTagsManager::setTagLibrary(TagLibrary::Library *const library) {
     tagLibrary_ = library;
@@ -422,31 +466,423 @@ void FileTagsManager::setBackupOnSave(bool value) {
     this->backupOnSave_ = value;
 }
 
-std::expected<std::reference_wrapper<FileTags>, QString> FileTagsManager::forFile(const QString &path) {
+void FileTagsManager::setProjectIndex(std::shared_ptr<ProjectIndex> projectIndex) {
+    QMutexLocker locker(&projectIndexMutex_);
+    projectIndex_ = std::move(projectIndex);
+}
+
+std::shared_ptr<ProjectIndex> FileTagsManager::projectIndex() const {
+    QMutexLocker locker(&projectIndexMutex_);
+    return projectIndex_;
+}
+
+void FileTagsManager::setCacheCapacity(qsizetype const capacityBytes, qsizetype const capacityEntries) {
+    ZoneScoped;
+    gsl_Expects(capacityBytes >= 0);
+    gsl_Expects(capacityEntries >= 0);
+
+    capacityBytes_ = capacityBytes;
+    capacityEntries_ = capacityEntries;
+
+    for (auto &shard: shards_) {
+        QMutexLocker locker(&shard.mutex);
+        evict_(shard);
+    }
+}
+
+std::expected<std::shared_ptr<FileTags>, QString> FileTagsManager::forFile(const QString &path) {
     ZoneScoped;
     gsl_Expects(!QFileInfo(path).isDir());
     gsl_Expects(QFileInfo(path).isAbsolute());
     gsl_Expects(IMAGE_FILE_SUFFIXES.contains("."+QFileInfo(path).suffix()));
 
-    QMutexLocker locker(&mutex_);
+    auto &shard = shardFor(path);
 
-    auto it = fileTags_.find(path);
-    if (it == fileTags_.end()) {
-        QFileInfo fileInfo{path};
+    std::shared_ptr<Entry> entry;
+    {
+        QMutexLocker locker(&shard.mutex);
 
-        auto tagsFilePath = fileInfo.dir().filePath(fileInfo.fileName() + Constants::TAGS_FILE_SUFFIX.toString());
+        auto it = shard.entries.find(path);
+        if (it != shard.entries.end() && !(it->second->done && !it->second->fileTags)) {
+            entry = it->second;
+            if (entry->done) {
+                touch_(shard, *entry);
+                return entry->fileTags;
+            }
+        } else {
+            if (it != shard.entries.end())
+                remove_(shard, it);
+            entry = std::make_shared<Entry>();
+            shard.entries.emplace(path, entry);
+        }
+    }
 
-        if (auto result = FileTags::create(*this, path, tagsFilePath, backupOnSave_); !result)
-            return std::unexpected(result.error());
-        else
-            std::tie(it, std::ignore) = fileTags_.emplace(path, std::move(*result));
+    // a load queued in the background is taken over, rather than waited for
+    if (!entry->claimed.exchange(true))
+        load(path, entry);
+    else
+        entry->future.wait();
+
+    // holding the entry keeps it from being evicted in between
+    QMutexLocker locker(&shard.mutex);
+    if (!entry->fileTags)
+        return std::unexpected(entry->error);
+
+    touch_(shard, *entry);
+    return entry->fileTags;
+}
+
+std::expected<std::shared_ptr<FileTags>, QString> FileTagsManager::forFileIfLoaded(QString const &path) {
+    ZoneScoped;
+    gsl_Expects(!QFileInfo(path).isDir());
+    gsl_Expects(QFileInfo(path).isAbsolute());
+    gsl_Expects(IMAGE_FILE_SUFFIXES.contains("."+QFileInfo(path).suffix()));
+
+    auto &shard = shardFor(path);
+
+    std::shared_ptr<Entry> entry;
+    {
+        QMutexLocker locker(&shard.mutex);
+
+        auto it = shard.entries.find(path);
+        if (it == shard.entries.end()) {
+            entry = std::make_shared<Entry>();
+            entry->notify = true;
+            shard.entries.emplace(path, entry);
+
+            threadPool_.start([this, path, entry]{
+                if (!entry->claimed.exchange(true))
+                    load(path, entry);
+            });
+            return nullptr;
+        }
+
+        entry = it->second;
+        if (entry->done) {
+            if (!entry->fileTags)
+                return std::unexpected(entry->error);
+
+            touch_(shard, *entry);
+            return entry->fileTags;
+        }
+    }
+
+    entry->notify = true;
+    // the load might have finished in between, without seeing the request
+    if (!entry->done)
+        return nullptr;
+
+    QMutexLocker locker(&shard.mutex);
+    if (!entry->fileTags)
+        return std::unexpected(entry->error);
+
+    touch_(shard, *entry);
+    return entry->fileTags;
+}
+
+bool FileTagsManager::invalidate(QString const &path) {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(path).isAbsolute());
+
+    {
+        // the change is most likely an own save still being reported back, which would otherwise look foreign
+        QMutexLocker locker(&saveMutex_);
+        if (savesInFlight_.contains(path))
+            return false;
     }
 
-    return *it->second;
+    auto &shard = shardFor(path);
+
+    std::shared_ptr<FileTags> pinned;
+    {
+        QMutexLocker locker(&shard.mutex);
+
+        // tags that aren't cached (anymore) might still be counted somewhere, so they're reported too
+        if (auto it = shard.entries.find(path); it != shard.entries.end()) {
+            auto const &entry = it->second;
+            if (entry->done && entry->fileTags) {
+                if (!entry->fileTags->isTagsFileChanged())
+                    return false;
+
+                if (entry->fileTags->isModified()) {
+                    qWarning() << "Tags file of" << path << "was changed on disk, but the tags have unsaved changes; keeping them";
+                    return false;
+                }
+
+                if (entry.use_count() != 1 || entry->fileTags.use_count() != 1)
+                    pinned = entry->fileTags;
+            }
+
+            // loads in progress might have read the previous content; whoever waits for them gets it, but the next
+            // caller loads again
+            if (!pinned)
+                remove_(shard, it);
+        }
+    }
+
+    // the only instance for the file stays in use, so it's refreshed rather than replaced
+    if (pinned)
+        if (auto result = pinned->rollbackChanges(); !result)
+            qWarning() << "Couldn't reload tags of" << path << ":" << result.error();
+
+    emit fileTagsInvalidated(path);
+    return true;
 }
 
-int FileTagsManager::cachedFiles() const {
-    QMutexLocker locker(&mutex_);
-    return fileTags_.size();
+void FileTagsManager::forget(QString const &path) {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(path).isAbsolute());
+
+    auto &shard = shardFor(path);
+    QMutexLocker locker(&shard.mutex);
+
+    auto it = shard.entries.find(path);
+    if (it == shard.entries.end())
+        return;
+
+    auto const &entry = it->second;
+    if (entry->done && entry->fileTags
+            && (entry->fileTags->isModified() || entry.use_count() != 1 || entry->fileTags.use_count() != 1))
+        return;
+
+    remove_(shard, it);
 }
 
+void FileTagsManager::flushSaves() {
+    ZoneScoped;
+    gsl_Expects(QThread::currentThread() == thread());
+
+    saveThreadPool_.waitForDone();
+    // results are queued to this thread, deliver them before returning
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+FileTagsManager::Counters FileTagsManager::cacheCounters() const {
+    Counters counters{
+        .capacityBytes = capacityBytes_,
+        .evictions = evictions_
+    };
+    for (auto const &shard: shards_) {
+        QMutexLocker locker(&shard.mutex);
+        counters.entries += static_cast<qsizetype>(shard.lru.size());
+        counters.bytes += shard.bytes;
+    }
+    return counters;
+}
+
+FileTagsManager::Shard &FileTagsManager::shardFor(QString const &path) {
+    return shards_[qHash(path) % SHARD_COUNT];
+}
+
+void FileTagsManager::load(QString const &path, std::shared_ptr<Entry> const &entry) {
+    ZoneScoped;
+
+    QFileInfo fileInfo{path};
+    auto tagsFilePath = fileInfo.dir().filePath(fileInfo.fileName() + Constants::TAGS_FILE_SUFFIX.toString());
+
+    auto result = FileTags::create(*this, path, tagsFilePath, backupOnSave_);
+
+    {
+        auto &shard = shardFor(path);
+        QMutexLocker locker(&shard.mutex);
+
+        if (!result) {
+            entry->error = result.error();
+        } else {
+            entry->fileTags = std::move(*result);
+            entry->cost = cost(path, entry->fileTags.get());
+
+            if (auto it = shard.entries.find(path); it != shard.entries.end() && it->second == entry) {
+                shard.lru.push_front(path);
+                entry->position = shard.lru.begin();
+                shard.bytes += entry->cost;
+            }
+        }
+
+        entry->done = true;
+        evict_(shard);
+    }
+
+    entry->loaded.set_value();
+
+    if (entry->notify)
+        emit fileTagsLoaded(path);
+}
+
+void FileTagsManager::enqueueSave(SaveRequest request) {
+    ZoneScoped;
+
+    QMutexLocker locker(&saveMutex_);
+
+    if (auto it = pendingSaves_.find(request.imageFilePath); it != pendingSaves_.end()) {
+        // not picked up by the writer yet, so only the latest snapshot is written; a requested backup still happens
+        request.backup = request.backup || it->second.backup;
+        it->second = std::move(request);
+        return;
+    }
+
+    auto path = request.imageFilePath;
+    saveOrder_.push_back(path);
+    pendingSaves_.emplace(path, std::move(request));
+    ++savesInFlight_[path];
+
+    if (!saveRunning_) {
+        saveRunning_ = true;
+        saveThreadPool_.start([this]{ writeSaves(); });
+    }
+}
+
+void FileTagsManager::waitForSave(QString const &path) {
+    ZoneScoped;
+
+    QMutexLocker locker(&saveMutex_);
+    while (pendingSaves_.contains(path) || writingSave_ == path)
+        saveWritten_.wait(&saveMutex_);
+}
+
+void FileTagsManager::writeSaves() {
+    ZoneScoped;
+
+    while (true) {
+        SaveRequest request;
+        {
+            QMutexLocker locker(&saveMutex_);
+
+            writingSave_.clear();
+            saveWritten_.wakeAll();
+
+            if (saveOrder_.empty()) {
+                saveRunning_ = false;
+                return;
+            }
+
+            writingSave_ = std::move(saveOrder_.front());
+            saveOrder_.pop_front();
+            request = std::move(pendingSaves_.extract(writingSave_).mapped());
+        }
+
+        auto result = write(request);
+
+        QMetaObject::invokeMethod(this, [this, request = std::move(request), result = std::move(result)]{
+            saveDone(request, result);
+        }, Qt::QueuedConnection);
+    }
+}
+
+std::expected<FileTagsManager::SaveResult, QString> FileTagsManager::write(SaveRequest const &request) {
+    ZoneScoped;
+
+    QElapsedTimer saveTimer;
+    saveTimer.start();
+
+    bool backup = request.backup;
+
+    if (!backup) {
+        // First, open the original file, to see whether it can be opened without warnings. In case there were warnings,
+        // we first backup the original file
+        QFileInfo tagsFileInfo{request.tagsFilePath};
+
+        if (tagsFileInfo.exists()) {
+            auto res = loadTagsFile(request.tagsFilePath);
+            backup = backup || !res.has_value() || res->warningsOccurred;
+        }
+    }
+
+    SaveResult result;
+
+    if (backup)
+        result.backupCount = backupFile(request.tagsFilePath);
+
+    qDebug() << "Saving tags to" << request.tagsFilePath;
+
+    QSaveFile saveFile{request.tagsFilePath};
+    if (!saveFile.open(QIODevice::WriteOnly))
+        return std::unexpected(QObject::tr("Could not open %1 for writing: %2").arg(request.tagsFilePath).arg(saveFile.errorString()));
+
+    saveFile.write(request.content);
+
+    if (!saveFile.commit())
+        return std::unexpected(QObject::tr("Failed to write file %1: %2").arg(request.tagsFilePath).arg(saveFile.errorString()));
+
+    QFileInfo tagsFileInfo{request.tagsFilePath};
+    result.tagsFileModified = fileModified(tagsFileInfo);
+    result.tagsFileSize = fileSize(tagsFileInfo);
+
+    if (request.projectIndex)
+        request.projectIndex->update(request.imageFilePath, tagsFileInfo, request.indexEntry);
+
+    qDebug() << "Total saving time:" << saveTimer.elapsed() << "ms";
+    return result;
+}
+
+void FileTagsManager::saveDone(SaveRequest const &request, std::expected<SaveResult, QString> const &result) {
+    ZoneScoped;
+
+    {
+        QMutexLocker locker(&saveMutex_);
+        if (auto it = savesInFlight_.find(request.imageFilePath); --it->second == 0)
+            savesInFlight_.erase(it);
+    }
+
+    if (result) {
+        request.fileTags->tagsFileModified_ = result->tagsFileModified;
+        request.fileTags->tagsFileSize_ = result->tagsFileSize;
+    } else if (!request.fileTags->isModified()) {
+        // not on disk, so unsaved again; that also keeps the tags from being evicted until saved or rolled back
+        request.fileTags->setModified_(true);
+    }
+
+    emit tagsSaved(request.imageFilePath, result.transform([](auto const &saved){ return saved.backupCount; }));
+}
+
+qsizetype FileTagsManager::cost(QString const &path, FileTags const *const fileTags) {
+    // the map key, the LRU list and the tags themselves each hold a copy of the image path, and the tags hold the
+    // tags file path on top; the rest is a rough allowance for the allocations of the containers
+    constexpr qsizetype OVERHEAD = 256;
+    return static_cast<qsizetype>(sizeof(Entry) + sizeof(FileTags))
+            + 4 * path.size() * static_cast<qsizetype>(sizeof(QChar))
+            + (fileTags ? fileTags->assignedTagIds().size() * static_cast<qsizetype>(sizeof(TagId)) : 0)
+            + OVERHEAD;
+}
+
+void FileTagsManager::touch_(Shard &shard, Entry &entry) {
+    if (entry.position)
+        shard.lru.splice(shard.lru.begin(), shard.lru, *entry.position);
+}
+
+void FileTagsManager::remove_(Shard &shard, decltype(Shard::entries)::iterator const it) {
+    auto &entry = *it->second;
+    if (entry.position) {
+        shard.lru.erase(*entry.position);
+        shard.bytes -= entry.cost;
+    }
+    shard.entries.erase(it);
+}
+
+void FileTagsManager::evict_(Shard &shard) {
+    ZoneScoped;
+
+    auto capacityBytes = capacityBytes_ / SHARD_COUNT;
+    auto capacityEntries = capacityEntries_ / SHARD_COUNT;
+
+    // walk from the least recently used entry, skipping the pinned ones: referenced outside of the cache (which
+    // includes loads being waited for), or with unsaved changes
+    auto position = shard.lru.end();
+    while ((shard.bytes > capacityBytes || static_cast<qsizetype>(shard.lru.size()) > capacityEntries)
+            && position != shard.lru.begin()) {
+        --position;
+
+        auto it = shard.entries.find(*position);
+        gsl_Assert(it != shard.entries.end());
+        auto const &entry = it->second;
+        if (entry.use_count() != 1 || entry->fileTags.use_count() != 1 || entry->fileTags->isModified())
+            continue;
+
+        // erasing invalidates only the erased element, so step past it first
+        ++position;
+        remove_(shard, it);
+        ++evictions_;
+    }
+
+    gsl_Ensures(shard.bytes >= 0);
+}
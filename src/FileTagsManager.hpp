@@ -16,6 +16,9 @@
 */
 #pragma once
 
+#include "ProjectIndex.hpp"
+#include "TagDictionary.hpp"
+
 class FileTagsManager;
 class Project;
 
@@ -23,7 +26,9 @@ namespace TagLibrary {
 class Library;
 }
 
-class FileTags {
+class FileTags: public std::enable_shared_from_this<FileTags> {
+    friend class FileTagsManager;
+
     FileTags(
             FileTagsManager &manager,
             QString const &imageFilePath,
@@ -49,6 +54,7 @@ public:
     ~FileTags();
 
     [[nodiscard]] QStringList assignedTags() const;
+    [[nodiscard]] TagIdList const &assignedTagIds() const;
     [[nodiscard]] bool setTags(QStringList const &tag, bool value);
     [[nodiscard]] bool setTagsState(std::unordered_map<QString, bool> const &state);
     [[nodiscard]] bool overwriteAssignedTags(QStringList const &activeTags);
@@ -72,28 +78,40 @@ public:
     [[nodiscard]] bool isModified() const;
     [[nodiscard]] std::expected<void, QString> rollbackChanges();
 
+    // whether the tags file was changed by someone else since it was last loaded or saved; costs a stat, not a read
+    [[nodiscard]] bool isTagsFileChanged() const;
+
 private:
     [[nodiscard]] std::expected<void, QString> load();
 
 public:
+    // Snapshots the tags and queues them for writing in the background; the tags count as saved right away. Results,
+    // including errors, are reported by FileTagsManager::tagsSaved() once the file is written. A failed write marks the
+    // tags modified again.
     [[nodiscard]] std::expected<void, QString> save(bool forceSave = false, bool forceBackup = false);
 
 private:
     void setModified_(bool modified);
+    [[nodiscard]] ProjectIndex::Entry toIndexEntry() const;
 
     FileTagsManager &manager_;
     QString imageFilePath_;
     QString tagsFilePath_;
     bool backupOnSave_ = false;
-    bool modified_ = false;
+    // read by the cache eviction from any thread
+    std::atomic_bool modified_ = false;
 
-    QStringList assignedTags_;
+    TagIdList assignedTags_;
     std::optional<QRect> imageRegion_;
     bool completeFlag_ = false;
 
     std::optional<QUuid> tagLibraryUuid_;
     std::optional<int> tagLibraryVersion_ = -1;
     std::optional<QUuid> tagLibraryVersionUuid_;
+
+    // state of the tags file as last loaded or saved; -1 if the tags file didn't exist
+    qint64 tagsFileModified_ = -1;
+    qint64 tagsFileSize_ = -1;
 };
 
 class FileTagsManager: public QObject {
@@ -114,19 +132,147 @@ public:
 
     void setBackupOnSave(bool value);
 
-    [[nodiscard]] std::expected<std::reference_wrapper<FileTags>, QString> forFile(QString const &path);
+    // index is used to avoid parsing tags files that didn't change; may be null
+    void setProjectIndex(std::shared_ptr<ProjectIndex> projectIndex);
+    [[nodiscard]] std::shared_ptr<ProjectIndex> projectIndex() const;
+
+    // Unmodified tags are evicted from the cache, least recently used first, once it exceeds either of the limits.
+    // Tags still referenced outside of the cache are never evicted, which pins the ones open for editing.
+    void setCacheCapacity(qsizetype capacityBytes, qsizetype capacityEntries = std::numeric_limits<qsizetype>::max());
+
+    // Loads the tags if they aren't loaded yet. Concurrent calls for the same file wait for a single load, calls for
+    // other files don't wait at all. A failed load is retried on the next call. The returned tags stay valid for as
+    // long as they're referenced, and are the only instance for the file until released.
+    [[nodiscard]] std::expected<std::shared_ptr<FileTags>, QString> forFile(QString const &path);
+
+    // Non-blocking variant for the GUI thread: returns null while the tags aren't loaded yet, in which case they're
+    // loaded in the background and fileTagsLoaded() is emitted once done. A failed load is reported until forFile()
+    // retries it.
+    [[nodiscard]] std::expected<std::shared_ptr<FileTags>, QString> forFileIfLoaded(QString const &path);
 
-    int cachedFiles() const;
+    // Called when the tags file of the given image was changed on disk. Drops the cached tags, or reloads them in place
+    // if they're referenced outside of the cache, and emits fileTagsInvalidated(). Returns false if there's nothing
+    // to update: the change is an own save (possibly still being written), or the tags have unsaved changes, which are
+    // kept.
+    bool invalidate(QString const &path);
+
+    // Called when the image was deleted. Drops its cached tags, unless they're referenced outside of the cache or
+    // have unsaved changes.
+    void forget(QString const &path);
+
+    // Waits until all queued saves are written and delivers their tagsSaved() signals. Must be called from the thread
+    // the manager lives in.
+    void flushSaves();
+
+    struct Counters {
+        qsizetype entries = 0;
+        qsizetype bytes = 0;
+        qsizetype capacityBytes = 0;
+        quint64 evictions = 0;
+    };
+
+    [[nodiscard]] Counters cacheCounters() const;
 
 signals:
-    void tagsSaved(std::optional<int> const &backupCount);
+    // the result holds the number of the backup made before writing, if any
+    void tagsSaved(QString const &imageFileName, std::expected<std::optional<int>, QString> const &result);
     void modifiedStateChanged(QString const &imageFileName, bool modified);
+    // emitted from a worker thread
+    void fileTagsLoaded(QString const &imageFileName);
+    void fileTagsInvalidated(QString const &imageFileName);
 
 private:
-    TagLibrary::Library *tagLibrary_ = nullptr;
+    struct Entry {
+        // set by whoever starts the load first, so that a queued background load can be taken over
+        std::atomic_bool claimed = false;
+        // someone got the "not loaded yet" answer and has to be notified
+        std::atomic_bool notify = false;
+        std::atomic_bool done = false;
+
+        std::promise<void> loaded;
+        std::shared_future<void> future = loaded.get_future().share();
+
+        // all below are guarded by the shard mutex; the first two are set before `done`, and immutable afterwards
+        std::shared_ptr<FileTags> fileTags;
+        QString error;
+        // only loaded entries are in the LRU list
+        std::optional<std::list<QString>::iterator> position;
+        qsizetype cost = 0;
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        std::unordered_map<QString, std::shared_ptr<Entry>> entries;
+        // most recently used entries at the front
+        std::list<QString> lru;
+        qsizetype bytes = 0;
+    };
+
+    static constexpr int SHARD_COUNT = 16;
+
+    [[nodiscard]] Shard &shardFor(QString const &path);
+    void load(QString const &path, std::shared_ptr<Entry> const &entry);
+    [[nodiscard]] static qsizetype cost(QString const &path, FileTags const *fileTags);
+
+    struct SaveRequest {
+        // keeps the tags cached until the write is reported back
+        std::shared_ptr<FileTags> fileTags;
+        QString imageFilePath;
+        QString tagsFilePath;
+        bool backup = false;
+        QByteArray content;
+        std::shared_ptr<ProjectIndex> projectIndex;
+        ProjectIndex::Entry indexEntry;
+    };
+
+    struct SaveResult {
+        std::optional<int> backupCount;
+        qint64 tagsFileModified = -1;
+        qint64 tagsFileSize = -1;
+    };
+
+    void enqueueSave(SaveRequest request);
+    // blocks until the file's queued save, if any, is on disk, so that reading it gives the latest saved state
+    void waitForSave(QString const &path);
+    void writeSaves();
+    [[nodiscard]] static std::expected<SaveResult, QString> write(SaveRequest const &request);
+    // called in the manager's thread
+    void saveDone(SaveRequest const &request, std::expected<SaveResult, QString> const &result);
+
+    // all below require the shard mutex to be locked
+    void touch_(Shard &shard, Entry &entry);
+    void remove_(Shard &shard, decltype(Shard::entries)::iterator it);
+    void evict_(Shard &shard);
 
-    bool backupOnSave_ = false;
+    TagLibrary::Library *tagLibrary_ = nullptr;
 
-    mutable QMutex mutex_;
-    std::unordered_map<QString, std::unique_ptr<FileTags>> fileTags_;
+    std::atomic_bool backupOnSave_ = false;
+
+    mutable QMutex projectIndexMutex_;
+    std::shared_ptr<ProjectIndex> projectIndex_;
+
+    // entries are created under the lock of their shard, but loaded outside of it
+    std::array<Shard, SHARD_COUNT> shards_;
+
+    // split evenly between the shards
+    std::atomic<qsizetype> capacityBytes_ = std::numeric_limits<qsizetype>::max();
+    std::atomic<qsizetype> capacityEntries_ = std::numeric_limits<qsizetype>::max();
+    std::atomic<quint64> evictions_ = 0;
+
+    // Write-behind queue of saves, in the order the files were first queued. Saving a file that's still queued replaces
+    // its snapshot, so a burst of edits is written once.
+    QMutex saveMutex_;
+    std::list<QString> saveOrder_;
+    std::unordered_map<QString, SaveRequest> pendingSaves_;
+    // taken off the queue and being written right now
+    QString writingSave_;
+    QWaitCondition saveWritten_;
+    // queued or written, but not reported back yet, by image path
+    std::unordered_map<QString, int> savesInFlight_;
+    bool saveRunning_ = false;
+    // a single writer, so that saves of a file land in order; waited for in the destructor
+    QThreadPool saveThreadPool_;
+
+    // placed last, so that it's destroyed (and waits for running jobs) before everything the jobs use
+    QThreadPool threadPool_;
 };
@@ -0,0 +1,217 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "ImagePrefetcher.hpp"
+
+namespace ImageViewer {
+namespace {
+    // full size decodes are memory heavy, so keep the number of concurrently decoded images low
+    constexpr int PREFETCH_THREADS = 2;
+
+    // rough per-entry bookkeeping overhead (list node, hash node, path string, QImage header)
+    constexpr qsizetype ENTRY_OVERHEAD = 256;
+}
+
+ImagePrefetcher::ImagePrefetcher(qsizetype const capacityBytes): capacityBytes_(capacityBytes) {
+    gsl_Expects(capacityBytes >= 0);
+    threadPool_.setMaxThreadCount(PREFETCH_THREADS);
+}
+
+ImagePrefetcher::~ImagePrefetcher() {
+    clear();
+}
+
+void ImagePrefetcher::setCapacity(qsizetype const capacityBytes) {
+    ZoneScoped;
+    gsl_Expects(capacityBytes >= 0);
+
+    QMutexLocker locker(&mutex_);
+    capacityBytes_ = capacityBytes;
+    evict_();
+}
+
+QImage ImagePrefetcher::image(QString const &path) {
+    ZoneScoped;
+
+    auto lastModified = QFileInfo(path).lastModified();
+
+    std::shared_ptr<Job> job;
+    {
+        QMutexLocker locker(&mutex_);
+
+        auto entry = index_.find(path);
+        if (entry != index_.end() && entry->second->lastModified == lastModified) {
+            ++hits_;
+            entries_.splice(entries_.begin(), entries_, entry->second);
+            return entry->second->image;
+        }
+
+        ++misses_;
+        if (entry != index_.end())
+            remove_(path);
+
+        if (auto it = jobs_.find(path); it != jobs_.end()) {
+            job = it->second;
+            jobs_.erase(it);
+        }
+    }
+
+    QImage result;
+    if (job && job->claimed.exchange(true)) {
+        // a worker is already decoding this image, which is bound to be faster than starting over
+        result = job->future.get();
+    } else {
+        if (job)
+            job->cancelled = true;
+        result = decode(path);
+    }
+
+    QMutexLocker locker(&mutex_);
+    insert_(path, result, lastModified);
+    return result;
+}
+
+void ImagePrefetcher::prefetch(QStringList const &paths) {
+    ZoneScoped;
+
+    QMutexLocker locker(&mutex_);
+
+    std::unordered_set<QString> wanted(paths.begin(), paths.end());
+    std::erase_if(jobs_, [&](auto const &item) {
+        if (wanted.contains(item.first))
+            return false;
+        item.second->cancelled = true;
+        return true;
+    });
+
+    for (auto i = 0; i != paths.size(); ++i) {
+        auto const &path = paths[i];
+
+        if (auto entry = index_.find(path); entry != index_.end()) {
+            // keep the neighbours from being evicted before images that are further away
+            entries_.splice(entries_.begin(), entries_, entry->second);
+            continue;
+        }
+
+        if (jobs_.contains(path))
+            continue;
+
+        auto job = std::make_shared<Job>();
+        jobs_.emplace(path, job);
+
+        // closest neighbours first
+        threadPool_.start([this, path, job]{
+            ZoneScoped;
+
+            if (job->cancelled || job->claimed.exchange(true))
+                return;
+
+            auto lastModified = QFileInfo(path).lastModified();
+            auto image = decode(path);
+
+            {
+                QMutexLocker locker(&mutex_);
+                if (!job->cancelled)
+                    insert_(path, image, lastModified);
+                if (auto it = jobs_.find(path); it != jobs_.end() && it->second == job)
+                    jobs_.erase(it);
+            }
+
+            job->promise.set_value(image);
+        }, static_cast<int>(paths.size() - i));
+    }
+}
+
+void ImagePrefetcher::clear() {
+    ZoneScoped;
+
+    QMutexLocker locker(&mutex_);
+
+    for (auto &[path, job]: jobs_)
+        job->cancelled = true;
+    jobs_.clear();
+
+    entries_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+ImagePrefetcher::Counters ImagePrefetcher::counters() const {
+    QMutexLocker locker(&mutex_);
+    return Counters{
+        .hits = hits_,
+        .misses = misses_,
+        .evictions = evictions_,
+        .entries = static_cast<qsizetype>(entries_.size()),
+        .bytes = bytes_,
+        .capacityBytes = capacityBytes_
+    };
+}
+
+QImage ImagePrefetcher::decode(QString const &path) {
+    ZoneScoped;
+
+    QImage image(path);
+    if (image.isNull()) {
+        qWarning() << "ImagePrefetcher: could not decode" << path;
+        return image;
+    }
+
+    // format QPixmap::fromImage can take without another conversion on the GUI thread
+    image.convertTo(image.hasAlphaChannel() ? QImage::Format::Format_ARGB32_Premultiplied : QImage::Format::Format_RGB32);
+    return image;
+}
+
+qsizetype ImagePrefetcher::cost(QImage const &image) {
+    return image.sizeInBytes() + ENTRY_OVERHEAD;
+}
+
+void ImagePrefetcher::insert_(QString const &path, QImage const &image, QDateTime const &lastModified) {
+    ZoneScoped;
+
+    remove_(path);
+
+    entries_.emplace_front(Entry{.path = path, .image = image, .lastModified = lastModified});
+    index_.emplace(path, entries_.begin());
+    bytes_ += cost(image);
+
+    evict_();
+
+    gsl_Ensures(bytes_ >= 0);
+    gsl_Ensures(entries_.size() == index_.size());
+}
+
+void ImagePrefetcher::remove_(QString const &path) {
+    if (auto it = index_.find(path); it != index_.end()) {
+        bytes_ -= cost(it->second->image);
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+}
+
+void ImagePrefetcher::evict_() {
+    ZoneScoped;
+
+    // evict least recently used entries; a single entry bigger than the whole budget is dropped too
+    while (bytes_ > capacityBytes_ && !entries_.empty()) {
+        auto &entry = entries_.back();
+        bytes_ -= cost(entry.image);
+        index_.erase(entry.path);
+        entries_.pop_back();
+        ++evictions_;
+    }
+}
+}
@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+namespace ImageViewer {
+// Decodes images expected to be viewed next in the background, keeping the results in an LRU cache bounded by total
+// size of the decoded images in bytes. All public methods are meant to be called from the GUI thread.
+class ImagePrefetcher {
+public:
+    ImagePrefetcher(ImagePrefetcher const &other) = delete;
+    ImagePrefetcher(ImagePrefetcher &&other) = delete;
+    ImagePrefetcher &operator=(ImagePrefetcher const &other) = delete;
+    ImagePrefetcher &operator=(ImagePrefetcher &&other) = delete;
+
+    explicit ImagePrefetcher(qsizetype capacityBytes);
+    ~ImagePrefetcher();
+
+    struct Counters {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qsizetype entries = 0;
+        qsizetype bytes = 0;
+        qsizetype capacityBytes = 0;
+    };
+
+    void setCapacity(qsizetype capacityBytes);
+
+    // Returns decoded image. Served from the cache if prefetched already, waits for the decode if it's in progress,
+    // decodes synchronously otherwise.
+    [[nodiscard]] QImage image(QString const &path);
+
+    // Replaces the set of images to prefetch; paths should be ordered from the most to the least likely to be viewed
+    // next. Queued decodes of paths no longer on the list are cancelled.
+    void prefetch(QStringList const &paths);
+
+    void clear();
+
+    [[nodiscard]] Counters counters() const;
+
+private:
+    struct Job {
+        // set by whoever (worker or GUI thread) does the decode first
+        std::atomic<bool> claimed = false;
+        std::atomic<bool> cancelled = false;
+        std::promise<QImage> promise;
+        std::shared_future<QImage> future = promise.get_future().share();
+    };
+
+    struct Entry {
+        QString path;
+        QImage image;
+        QDateTime lastModified;
+    };
+
+    static QImage decode(QString const &path);
+    static qsizetype cost(QImage const &image);
+
+    // all below require mutex_ to be locked
+    void insert_(QString const &path, QImage const &image, QDateTime const &lastModified);
+    void remove_(QString const &path);
+    void evict_();
+
+    mutable QMutex mutex_;
+    qsizetype capacityBytes_ = 0;
+    qsizetype bytes_ = 0;
+
+    // most recently used entries at the front
+    std::list<Entry> entries_;
+    std::unordered_map<QString, decltype(entries_)::iterator> index_;
+    std::unordered_map<QString, std::shared_ptr<Job>> jobs_;
+
+    quint64 hits_ = 0;
+    quint64 misses_ = 0;
+    quint64 evictions_ = 0;
+
+    // placed last, so that it's destroyed (and waits for running jobs) before everything the jobs use
+    QThreadPool threadPool_;
+};
+}
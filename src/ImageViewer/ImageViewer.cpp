@@ -26,10 +26,12 @@
 namespace {
 constexpr float ZOOM_STEP_BUTTONS = 0.1f;
 constexpr float ZOOM_STEP_WHEEL = 0.1f/120.0f;
+constexpr qsizetype DEFAULT_IMAGE_CACHE_CAPACITY = 512 * 1024 * 1024;
 }
 
 namespace ImageViewer {
-ImageViewer::ImageViewer(FileEditor &fileEditor): ui(std::make_unique<Ui_ImageViewer>()), fileEditor_(fileEditor) {}
+ImageViewer::ImageViewer(FileEditor &fileEditor): ui(std::make_unique<Ui_ImageViewer>()), fileEditor_(fileEditor),
+        prefetcher_(DEFAULT_IMAGE_CACHE_CAPACITY) {}
 
 std::expected<void, QString> ImageViewer::init() {
     ZoneScoped;
@@ -185,11 +187,10 @@ void ImageViewer::loadFile(QString const &name) {
         toolTip += QString("%1<br>").arg(libraryVersionStr);
         ui->labelImagePath->setToolTip(toolTip);
 
-        QImage image(name);
-        viewFilePixmapItem.emplace(QPixmap::fromImage(image));
-        viewFilePixmapItem->setTransformationMode(Qt::SmoothTransformation);
+        auto image = prefetcher_.image(name);
+        viewFileImageItem.emplace(image);
 
-        viewFileScene.addItem(&*viewFilePixmapItem);
+        viewFileScene.addItem(&*viewFileImageItem);
 
         auto viewSelectionRectItemUnique = std::make_unique<GraphicsSelectionRectItem>(image.rect(), image.rect());
 
@@ -298,9 +299,9 @@ void ImageViewer::unloadFile() {
         viewSelectionRectItem = nullptr;
     }
 
-    if (viewFilePixmapItem) {
-        viewFileScene.removeItem(&*viewFilePixmapItem);
-        viewFilePixmapItem.reset();
+    if (viewFileImageItem) {
+        viewFileScene.removeItem(&*viewFileImageItem);
+        viewFileImageItem.reset();
     }
 
     ui->labelImagePath->clear();
@@ -311,6 +312,19 @@ void ImageViewer::unloadFile() {
     setEnabled(false);
 }
 
+void ImageViewer::prefetchFiles(QStringList const &names) {
+    ZoneScoped;
+    prefetcher_.prefetch(names);
+}
+
+void ImageViewer::setImageCacheCapacity(qsizetype const capacityBytes) {
+    prefetcher_.setCapacity(capacityBytes);
+}
+
+ImagePrefetcher::Counters ImageViewer::imageCacheCounters() const {
+    return prefetcher_.counters();
+}
+
 void ImageViewer::setZoom(float const zoom) {
     ZoneScoped;
 
@@ -329,8 +343,8 @@ void ImageViewer::setZoom(float const zoom) {
 void ImageViewer::setZoomToFitWholeImage() {
     ZoneScoped;
 
-    if (viewFilePixmapItem) {
-        ui->imageView->fitInView(&*viewFilePixmapItem, Qt::AspectRatioMode::KeepAspectRatio);
+    if (viewFileImageItem) {
+        ui->imageView->fitInView(&*viewFileImageItem, Qt::AspectRatioMode::KeepAspectRatio);
         extractZoomLevelFromCurrentTransformation();
         afterZoomChange();
     }
@@ -376,8 +390,8 @@ void ImageViewer::extractZoomLevelFromCurrentTransformation() {
 void ImageViewer::afterZoomChange() {
     ZoneScoped;
 
-    if (viewFilePixmapItem)
-        viewFileScene.setSceneRect(viewFilePixmapItem->sceneBoundingRect());
+    if (viewFileImageItem)
+        viewFileScene.setSceneRect(viewFileImageItem->sceneBoundingRect());
 
     if (viewSelectionRectItem)
         viewSelectionRectItem->setScaleCorrection(zoom_ * zoom_);
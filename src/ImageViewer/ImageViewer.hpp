@@ -15,6 +15,8 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #pragma once
+#include "ImagePrefetcher.hpp"
+#include "TiledImageItem.hpp"
 
 class Ui_ImageViewer;
 
@@ -44,6 +46,11 @@ public:
     void loadFile(QString const &name);
     void unloadFile();
 
+    // images likely to be loaded next, ordered from the most likely one
+    void prefetchFiles(QStringList const &names);
+    void setImageCacheCapacity(qsizetype capacityBytes);
+    [[nodiscard]] ImagePrefetcher::Counters imageCacheCounters() const;
+
     void setZoom(float zoom);
     void setZoomToFitWholeImage();
     void setZoomToFitSelectionRect();
@@ -66,8 +73,10 @@ private:
 
     float zoom_ = 1.0;
 
+    ImagePrefetcher prefetcher_;
+
     QGraphicsScene viewFileScene;
-    std::optional<QGraphicsPixmapItem> viewFilePixmapItem;
+    std::optional<TiledImageItem> viewFileImageItem;
     GraphicsSelectionRectItem *viewSelectionRectItem = nullptr;
 };
 }
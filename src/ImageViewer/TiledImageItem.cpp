@@ -0,0 +1,128 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "TiledImageItem.hpp"
+
+namespace ImageViewer {
+namespace {
+    constexpr int TILE_SIZE = 512;
+
+    // enough for a few screens worth of tiles at any level
+    constexpr qsizetype TILE_CACHE_CAPACITY_KIB = 128 * 1024;
+
+    quint64 tileKey(int const level, int const column, int const row) {
+        return (static_cast<quint64>(level) << 48) | (static_cast<quint64>(row) << 24) | static_cast<quint64>(column);
+    }
+}
+
+TiledImageItem::TiledImageItem(QImage const &image, QGraphicsItem *parent):
+        QGraphicsObject(parent),
+        size_(image.size()),
+        pyramid_(std::make_shared<Pyramid>()),
+        tiles_(TILE_CACHE_CAPACITY_KIB) {
+    ZoneScoped;
+
+    setFlag(QGraphicsItem::GraphicsItemFlag::ItemUsesExtendedStyleOption);
+
+    pyramid_->levels.append(image);
+
+    QThreadPool::globalInstance()->start([pyramid = pyramid_, image, self = this]{
+        ZoneScoped;
+
+        auto previous = image;
+        while (std::max(previous.width(), previous.height()) > TILE_SIZE) {
+            auto next = previous.scaled(
+                    std::max(1, previous.width() / 2), std::max(1, previous.height() / 2),
+                    Qt::AspectRatioMode::IgnoreAspectRatio, Qt::TransformationMode::SmoothTransformation
+            );
+
+            // the item can't be destroyed while the mutex is held, see the destructor
+            QMutexLocker locker(&pyramid->mutex);
+            if (pyramid->cancelled)
+                return;
+
+            pyramid->levels.append(next);
+            QMetaObject::invokeMethod(self, [self]{ self->update(); }, Qt::ConnectionType::QueuedConnection);
+
+            previous = next;
+        }
+    });
+}
+
+TiledImageItem::~TiledImageItem() {
+    QMutexLocker locker(&pyramid_->mutex);
+    pyramid_->cancelled = true;
+}
+
+QRectF TiledImageItem::boundingRect() const {
+    return QRectF(QPointF(0, 0), size_);
+}
+
+void TiledImageItem::paint(QPainter *painter, QStyleOptionGraphicsItem const *option, QWidget */*widget*/) {
+    ZoneScoped;
+
+    if (size_.isEmpty())
+        return;
+
+    // device pixels per image pixel
+    auto lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    auto level = lod >= 1.0 ? 0 : static_cast<int>(std::floor(std::log2(1.0 / lod)));
+
+    QImage levelImage;
+    {
+        QMutexLocker locker(&pyramid_->mutex);
+        level = std::clamp(level, 0, static_cast<int>(pyramid_->levels.size()) - 1);
+        levelImage = pyramid_->levels[level];
+    }
+
+    auto scaleX = static_cast<qreal>(size_.width()) / levelImage.width();
+    auto scaleY = static_cast<qreal>(size_.height()) / levelImage.height();
+
+    auto exposed = option->exposedRect & boundingRect();
+    auto firstColumn = std::max(0, static_cast<int>(exposed.left() / scaleX) / TILE_SIZE);
+    auto lastColumn = std::min((levelImage.width() - 1) / TILE_SIZE, static_cast<int>(exposed.right() / scaleX) / TILE_SIZE);
+    auto firstRow = std::max(0, static_cast<int>(exposed.top() / scaleY) / TILE_SIZE);
+    auto lastRow = std::min((levelImage.height() - 1) / TILE_SIZE, static_cast<int>(exposed.bottom() / scaleY) / TILE_SIZE);
+
+    painter->setRenderHint(QPainter::RenderHint::SmoothPixmapTransform);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            auto pixmap = tile(level, levelImage, column, row);
+            QRectF target(
+                    column * TILE_SIZE * scaleX, row * TILE_SIZE * scaleY,
+                    pixmap.width() * scaleX, pixmap.height() * scaleY
+            );
+            painter->drawPixmap(target, pixmap, QRectF(pixmap.rect()));
+        }
+    }
+}
+
+QPixmap TiledImageItem::tile(int const level, QImage const &levelImage, int const column, int const row) {
+    ZoneScoped;
+
+    auto key = tileKey(level, column, row);
+    if (auto pixmap = tiles_.object(key))
+        return *pixmap;
+
+    auto rect = QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE) & levelImage.rect();
+    auto pixmap = QPixmap::fromImage(levelImage.copy(rect));
+
+    auto cost = std::max<qsizetype>(1, static_cast<qsizetype>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8 / 1024);
+    tiles_.insert(key, new QPixmap(pixmap), cost);
+    return pixmap;
+}
+}
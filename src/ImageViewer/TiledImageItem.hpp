@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+namespace ImageViewer {
+// Image item that paints only the tiles intersecting the exposed area, taken from the level of a mip pyramid matching
+// the current zoom. The pyramid is built in the background; until a level is ready, the closest finer one is used.
+// Item coordinates are the full resolution image pixels, the same as with QGraphicsPixmapItem.
+class TiledImageItem: public QGraphicsObject {
+    Q_OBJECT
+
+public:
+    TiledImageItem(TiledImageItem const &other) = delete;
+    TiledImageItem(TiledImageItem &&other) = delete;
+    TiledImageItem& operator=(TiledImageItem const &other) = delete;
+    TiledImageItem& operator=(TiledImageItem &&other) = delete;
+
+    explicit TiledImageItem(QImage const &image, QGraphicsItem *parent = nullptr);
+    ~TiledImageItem() override;
+
+    [[nodiscard]] QRectF boundingRect() const override;
+    void paint(QPainter *painter, QStyleOptionGraphicsItem const *option, QWidget *widget) override;
+
+private:
+    // shared with the background job building the levels
+    struct Pyramid {
+        QMutex mutex;
+        // level N is the image downscaled 2^N times; level 0 is always present
+        QList<QImage> levels;
+        bool cancelled = false;
+    };
+
+    QPixmap tile(int level, QImage const &levelImage, int column, int row);
+
+    QSize size_;
+    std::shared_ptr<Pyramid> pyramid_;
+
+    // keyed by level, row and column; cost in KiB
+    QCache<quint64, QPixmap> tiles_;
+};
+}
@@ -35,6 +35,9 @@ using namespace std::literals;
 
 namespace {
     constexpr qsizetype MAX_RECENT_PROJECTS = 10;
+
+    // the index is saved on exit as well, this only bounds what an unclean exit loses
+    constexpr auto PROJECT_INDEX_SAVE_INTERVAL = 1min;
 }
 
 MainWindow::MainWindow(Settings &settings, QTranslator &translator, QString const &tagLibraryPath):
@@ -52,6 +55,8 @@ MainWindow::MainWindow(Settings &settings, QTranslator &translator, QString cons
 
         tagLibraryPath_ = appData.filePath("TagLibrary.cbor");
     }
+
+    tagLibraryJournalPath_ = tagLibraryPath_ + ".journal";
 }
 
 std::expected<void, QString> MainWindow::init() {
@@ -59,13 +64,32 @@ std::expected<void, QString> MainWindow::init() {
 
     ui->setupUi(this);
 
-    connect(&fileTagsManager, &FileTagsManager::tagsSaved, [this](auto const &count){
-        showSavedStatusMessage(tr("image tags"), count);
-        if (auto result = load(currentPath, true); !result) // force refreshing e.g. version notification
-            if (auto error = std::get_if<Error>(&result.error())) // ignore cancel
+    // saves are written in the background, so failures are only known here
+    connectionTagsSaved = connect(&fileTagsManager, &FileTagsManager::tagsSaved, this, [this](auto const &imageFileName, auto const &result){
+        if (!result) {
+            reportError(tr("Saving tags failed"), result.error());
+            return;
+        }
+
+        showSavedStatusMessage(tr("image tags"), *result);
+        if (imageFileName != currentPath)
+            return;
+        if (auto result2 = load(currentPath, true); !result2) // force refreshing e.g. version notification
+            if (auto error = std::get_if<Error>(&result2.error())) // ignore cancel
                 reportError(tr("Reload failed"), *error);
     });
 
+    // saving prunes entries of deleted images, which takes a stat per entry, so it's done in the background
+    connect(&projectIndexTimer, &QTimer::timeout, this, [this]{
+        if (projectIndex)
+            QThreadPool::globalInstance()->start([projectIndex = projectIndex]{
+                if (auto result = projectIndex->save(); !result)
+                    qWarning() << "Couldn't save project index:" << result.error();
+            });
+    });
+    projectIndexTimer.setInterval(PROJECT_INDEX_SAVE_INTERVAL);
+    projectIndexTimer.start();
+
     fileEditor_.emplace(fileTagsManager);
 
     connect(&*fileEditor_, &FileEditor::projectSaved, this, [this](auto const &backupCount){
@@ -190,9 +214,27 @@ std::expected<void, QString> MainWindow::setupStatusBar() {
         else
             statusBarMemory->setText(tr("Could not get memory usage"));
 
-        statusCache->setText(tr("Cached %1 directories, %2 files")
+        auto thumbnails = fileBrowser->thumbnailCacheCounters();
+        auto images = imageViewer->imageCacheCounters();
+        auto files = fileTagsManager.cacheCounters();
+        statusCache->setText(tr("Cached %1 directories, %2 files (%3 / %4; %5 evictions), %6 thumbnails (%7 / %8; %9 hits, %10 misses, %11 evictions), %12 images (%13 / %14; %15 hits, %16 misses, %17 evictions)")
                 .arg(directoryStatsManager.cachedDirectories())
-                .arg(fileTagsManager.cachedFiles())
+                .arg(files.entries)
+                .arg(locale().formattedDataSize(files.bytes))
+                .arg(locale().formattedDataSize(files.capacityBytes))
+                .arg(files.evictions)
+                .arg(thumbnails.entries)
+                .arg(locale().formattedDataSize(thumbnails.bytes))
+                .arg(locale().formattedDataSize(thumbnails.capacityBytes))
+                .arg(thumbnails.hits)
+                .arg(thumbnails.misses)
+                .arg(thumbnails.evictions)
+                .arg(images.entries)
+                .arg(locale().formattedDataSize(images.bytes))
+                .arg(locale().formattedDataSize(images.capacityBytes))
+                .arg(images.hits)
+                .arg(images.misses)
+                .arg(images.evictions)
         );
     });
 
@@ -357,8 +399,8 @@ std::expected<void, QString> MainWindow::setupFileBrowserDock() {
                 if (!target)
                     return std::unexpected(target.error());
 
-                if (target->get().overwriteAssignedTags(source->get().assignedTags()))
-                    if (auto result = target->get().save(); !result)
+                if ((*target)->overwriteAssignedTags((*source)->assignedTags()))
+                    if (auto result = (*target)->save(); !result)
                         return std::unexpected(result.error());
 
                 return {};
@@ -408,15 +450,20 @@ std::expected<void, QString> MainWindow::setupTagLibraryDock() {
 
     {
         QFile file(tagLibraryPath_);
+        QFile journal(tagLibraryJournalPath_);
         if (file.exists()) {
             qDebug() << "Loading tag library from" << file.fileName();
-            if (auto const result = tagLibrary->loadContent(file); !result) {
+            if (auto const result = tagLibrary->loadContent(file, journal.exists() ? &journal : nullptr); !result) {
                 qWarning() << "Couldn't load tag library:" << result.error();
                 QMessageBox::critical(
                         this,
                         tr("Could not load tags library"),
                         tr("Loading from file \"%1\" failed: %2").arg(tagLibraryPath_, result.error())
                 );
+            } else if (journal.exists()) {
+                // the journal was left over by an unclean exit, and might end with a partially written entry that
+                // further entries can't be appended after
+                saveTagLibrary(true);
             }
         }
     }
@@ -427,33 +474,7 @@ std::expected<void, QString> MainWindow::setupTagLibraryDock() {
         if (editMode)
             return; // don't save on entering edit mode
 
-        std::optional<int> backupsCounter;
-
-        if (this->settings.system.backupOnAnyChange)
-            backupsCounter = backupFile(tagLibraryPath_);
-
-        QSaveFile file(tagLibraryPath_);
-        qDebug() << "Saving tag library to" << file.fileName();
-        if (auto const result = [&]->std::expected<void, QString>{
-                if (auto const result = tagLibrary->saveContent(file); !result)
-                    return result;
-
-                if (!file.commit())
-                    return std::unexpected(QString("Failed to commit file: %1").arg(file.errorString()));
-
-                return {};
-            }(); !result) {
-            qWarning() << "Couldn't save tag library:" << result.error();
-            QMessageBox::critical(
-                    this,
-                    tr("Could not save tags library"),
-                    tr("Saving to file \"%1\" failed: %2").arg(file.fileName(), result.error()));
-        } else {
-            qInfo() << "Tag library saved, backups count:" << (backupsCounter ? *backupsCounter : -1);
-            showSavedStatusMessage(tr("tags library"), backupsCounter);
-        }
-
-        tags_->setKnownTags(tagLibrary->allTags());
+        saveTagLibrary(false);
     });
 
     connect(&*tagLibrary, &TagLibrary::Library::tagsSelected, this, [this](QStringList const &tags){
@@ -516,8 +537,16 @@ MainWindow::~MainWindow() {
 
     writeSettings();
 
+    // saves queued since closeEvent() can't be reported anymore, but are still written by the flush
+    disconnect(connectionTagsSaved);
+    saveProjectIndex();
+
     // to prevent update signals related to destruction from triggering save
     disconnect(connectionSaveTagLibraryOnChange);
+
+    // compacted by closeEvent(), unless that failed or the window was never closed
+    if (QFile::exists(tagLibraryJournalPath_))
+        qInfo() << "Tag library journal" << tagLibraryJournalPath_ << "left in place, it's replayed on next load";
 }
 
 void MainWindow::changeEvent(QEvent *event) {
@@ -535,6 +564,17 @@ void MainWindow::changeEvent(QEvent *event) {
     QMainWindow::changeEvent(event);
 }
 
+void MainWindow::closeEvent(QCloseEvent *event) {
+    ZoneScoped;
+
+    // while the window is still whole, so that failed saves can be reported
+    fileTagsManager.flushSaves();
+    if (QFile::exists(tagLibraryJournalPath_))
+        saveTagLibrary(true);
+
+    QMainWindow::closeEvent(event);
+}
+
 void MainWindow::paintEvent(QPaintEvent *event) {
     FrameMarkNamed("MainWindow");
     ZoneScoped;
@@ -586,6 +626,9 @@ void MainWindow::readSettings() {
 
     fileEditor_->setBackupOnEverySave(this->settings.system.backupOnAnyChange);
     fileTagsManager.setBackupOnSave(this->settings.system.backupOnAnyChange);
+    fileBrowser->setThumbnailCacheCapacity(static_cast<qsizetype>(this->settings.system.thumbnailCacheSizeMiB) * 1024 * 1024);
+    imageViewer->setImageCacheCapacity(static_cast<qsizetype>(this->settings.system.imageCacheSizeMiB) * 1024 * 1024);
+    fileTagsManager.setCacheCapacity(static_cast<qsizetype>(this->settings.system.fileTagsCacheSizeMiB) * 1024 * 1024);
 
     QFont font;
     font.setPointSizeF(this->settings.interface.fontSize);
@@ -633,6 +676,21 @@ std::expected<void, QString> MainWindow::loadProject(QString const &filePath) {
             project.emplace(std::move(*p));
     }
 
+    // index belongs to the previous project, persist it before switching
+    saveProjectIndex();
+    projectIndex.reset();
+
+    if (project) {
+        if (auto result = ProjectIndex::create(
+                    project->path() + Constants::PROJECT_INDEX_FILE_SUFFIX.toString(), project->rootDir()
+            ); !result)
+            qWarning() << "Couldn't create project index:" << result.error();
+        else
+            projectIndex = std::move(*result);
+    }
+
+    fileTagsManager.setProjectIndex(projectIndex);
+
     QSettings settings;
     settings.setValue(SettingsKey::LAST_PROJECT_LOCATION, QFileInfo{filePath}.dir().path());
 
@@ -711,6 +769,7 @@ void MainWindow::loadFile(QString const &path) {
     qDebug() << "MainWindow::loadFile: " << path;
 
     imageViewer->loadFile(path);
+    imageViewer->prefetchFiles(fileBrowser->neighbourFiles(path, this->settings.system.imagePrefetchCount));
     tags_->setEnabled(true);
 
     tagLibrary->setEnabled(true);
@@ -802,6 +861,76 @@ void MainWindow::saveProject() {
 
 }
 
+void MainWindow::saveProjectIndex() {
+    ZoneScoped;
+
+    // queued tags saves update the index, and have to be on disk before the project is closed
+    fileTagsManager.flushSaves();
+
+    if (projectIndex)
+        if (auto result = projectIndex->save(); !result)
+            qWarning() << "Couldn't save project index:" << result.error();
+}
+
+void MainWindow::saveTagLibrary(bool const compact) {
+    ZoneScoped;
+
+    // Changes are appended to the journal next to the library. The library itself is rewritten (and backed up) only
+    // when the journal grows big compared to it, or on request, e.g. on exit.
+    QFileInfo libraryInfo(tagLibraryPath_);
+    QFileInfo journalInfo(tagLibraryJournalPath_);
+    if (!compact && libraryInfo.exists() && journalInfo.size() <= libraryInfo.size() / 2) {
+        QFile journal(tagLibraryJournalPath_);
+        qDebug() << "Saving tag library changes to" << journal.fileName();
+        if (auto const result = tagLibrary->saveJournal(journal); !result) {
+            qWarning() << "Couldn't save tag library changes to journal, saving whole library:" << result.error();
+        } else {
+            // The library isn't rewritten while there's a journal, so backing it up once, when the journal is
+            // started, keeps every version recoverable, just like a backup on each rewrite does.
+            std::optional<int> backupsCounter;
+            if (this->settings.system.backupOnAnyChange && !journalInfo.exists() && journal.exists())
+                backupsCounter = backupFile(tagLibraryPath_);
+
+            showSavedStatusMessage(tr("tags library"), backupsCounter);
+            tags_->setKnownTags(tagLibrary->allTags());
+            return;
+        }
+    }
+
+    std::optional<int> backupsCounter;
+
+    if (this->settings.system.backupOnAnyChange)
+        backupsCounter = backupFile(tagLibraryPath_);
+
+    QSaveFile file(tagLibraryPath_);
+    qDebug() << "Saving tag library to" << file.fileName();
+    if (auto const result = [&]->std::expected<void, QString>{
+            if (auto const result = tagLibrary->saveContent(file); !result)
+                return result;
+
+            if (!file.commit())
+                return std::unexpected(QString("Failed to commit file: %1").arg(file.errorString()));
+
+            // everything in the journal is in the library now; were this not reached, the journal would no longer
+            // match the library version and would be ignored on load anyway
+            if (QFile::exists(tagLibraryJournalPath_) && !QFile::remove(tagLibraryJournalPath_))
+                qWarning() << "Couldn't remove tag library journal" << tagLibraryJournalPath_;
+
+            return {};
+        }(); !result) {
+        qWarning() << "Couldn't save tag library:" << result.error();
+        QMessageBox::critical(
+                this,
+                tr("Could not save tags library"),
+                tr("Saving to file \"%1\" failed: %2").arg(file.fileName(), result.error()));
+    } else {
+        qInfo() << "Tag library saved, backups count:" << (backupsCounter ? *backupsCounter : -1);
+        showSavedStatusMessage(tr("tags library"), backupsCounter);
+    }
+
+    tags_->setKnownTags(tagLibrary->allTags());
+}
+
 void MainWindow::showSavedStatusMessage(QString const &dataType, std::optional<int> const &backupsCounter) {
     if (!backupsCounter)
         statusBar()->showMessage(tr("Saved %1").arg(dataType));
@@ -19,6 +19,7 @@
 #include "FileEditor.hpp"
 #include "FileTagsManager.hpp"
 #include "Project.hpp"
+#include "ProjectIndex.hpp"
 #include "Utility.hpp"
 
 class Ui_MainWindow;
@@ -72,6 +73,7 @@ public:
 
 private:
     void changeEvent(QEvent *) override;
+    void closeEvent(QCloseEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
 
     void writeSettings();
@@ -86,19 +88,25 @@ private:
 
     void loadFileTaggerTagsToTagLibrary();
     void saveProject();
+    void saveProjectIndex();
+    // compact: rewrite the whole library instead of appending changes to its journal
+    void saveTagLibrary(bool compact);
     void showSavedStatusMessage(QString const &dataType, std::optional<int> const &backupsCounter);
 
     std::unique_ptr<Ui_MainWindow> ui;
     QTimer statsTimer;
+    QTimer projectIndexTimer;
 
     Settings &settings;
     QTranslator &translator;
 
     QString tagLibraryPath_;
+    QString tagLibraryJournalPath_;
 
     QStringList recentProjects;
     std::vector<std::unique_ptr<QAction>> recentProjectsActions;
     std::optional<Project> project;
+    std::shared_ptr<ProjectIndex> projectIndex;
 
     FileTagsManager fileTagsManager;
     DirectoryStatsManager directoryStatsManager;
@@ -124,4 +132,5 @@ private:
     QLabel *statusBarMemory = nullptr;
     QLabel *statusCache = nullptr;
     QMetaObject::Connection connectionSaveTagLibraryOnChange;
+    QMetaObject::Connection connectionTagsSaved;
 };
@@ -0,0 +1,298 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "ProjectIndex.hpp"
+
+#include "Utility.hpp"
+
+namespace {
+    enum class Key {
+        FORMAT_VERSION = 1,
+        APP = 2,
+        TAGS = 3,
+        ENTRIES = 4
+    };
+
+    // fields of a single entry, stored as an array to keep the index compact
+    enum class EntryField {
+        TAGS_FILE_MODIFIED = 0,
+        TAGS_FILE_SIZE = 1,
+        TAGS = 2,
+        REGION = 3,
+        COMPLETE_FLAG = 4,
+        TAG_LIBRARY_UUID = 5,
+        TAG_LIBRARY_VERSION = 6,
+        TAG_LIBRARY_VERSION_UUID = 7,
+        COUNT = 8
+    };
+
+    constexpr int valueFormatVersion = 1;
+    constexpr QAnyStringView valueApp = "SIMPLETAGGER-CXX";
+
+    qint64 tagsFileModified(QFileInfo const &tagsFileInfo) {
+        return tagsFileInfo.exists() ? tagsFileInfo.lastModified().toMSecsSinceEpoch() : -1;
+    }
+
+    qint64 tagsFileSize(QFileInfo const &tagsFileInfo) {
+        return tagsFileInfo.exists() ? tagsFileInfo.size() : -1;
+    }
+
+    std::expected<ProjectIndex::Entry, QString> entryFromCbor(QCborArray const &array, TagIdList const &tags) {
+        if (array.size() != std::to_underlying(EntryField::COUNT))
+            return std::unexpected(QObject::tr("Entry has %1 fields instead of %2").arg(array.size()).arg(std::to_underlying(EntryField::COUNT)));
+
+        auto at = [&](EntryField const field){ return array.at(std::to_underlying(field)); };
+
+        ProjectIndex::Entry entry;
+
+        if (!at(EntryField::TAGS_FILE_MODIFIED).isInteger() || !at(EntryField::TAGS_FILE_SIZE).isInteger())
+            return std::unexpected(QObject::tr("Tags file state is not an integer"));
+        entry.tagsFileModified = at(EntryField::TAGS_FILE_MODIFIED).toInteger();
+        entry.tagsFileSize = at(EntryField::TAGS_FILE_SIZE).toInteger();
+
+        if (!at(EntryField::TAGS).isArray())
+            return std::unexpected(QObject::tr("Tags are not an array but %1").arg(cborTypeToString(at(EntryField::TAGS).type())));
+        for (auto const &tagId: at(EntryField::TAGS).toArray()) {
+            if (!tagId.isInteger() || tagId.toInteger() < 0 || tagId.toInteger() >= tags.size())
+                return std::unexpected(QObject::tr("Invalid tag identifier"));
+            entry.assignedTags.append(tags.at(tagId.toInteger()));
+        }
+
+        if (auto region = at(EntryField::REGION); !region.isNull()) {
+            if (!region.isArray()
+                || region.toArray().size() != 4
+                || !std::ranges::all_of(region.toArray(), [](auto const &v){ return v.isInteger(); }))
+                return std::unexpected(QObject::tr("Region is not a 4-element integer array"));
+
+            auto regionArray = region.toArray();
+            auto left = regionArray.at(0).toInteger();
+            auto top = regionArray.at(1).toInteger();
+            auto right = regionArray.at(2).toInteger();
+            auto bottom = regionArray.at(3).toInteger();
+            entry.imageRegion = QRect(left, top, right - left + 1, bottom - top + 1);
+        }
+
+        if (!at(EntryField::COMPLETE_FLAG).isBool())
+            return std::unexpected(QObject::tr("Complete flag is not a bool but %1").arg(cborTypeToString(at(EntryField::COMPLETE_FLAG).type())));
+        entry.completeFlag = at(EntryField::COMPLETE_FLAG).toBool();
+
+        if (auto uuid = at(EntryField::TAG_LIBRARY_UUID); uuid.isByteArray())
+            entry.tagLibraryUuid = QUuid::fromRfc4122(uuid.toByteArray());
+
+        if (auto version = at(EntryField::TAG_LIBRARY_VERSION); version.isInteger())
+            entry.tagLibraryVersion = version.toInteger();
+
+        if (auto uuid = at(EntryField::TAG_LIBRARY_VERSION_UUID); uuid.isByteArray())
+            entry.tagLibraryVersionUuid = QUuid::fromRfc4122(uuid.toByteArray());
+
+        return entry;
+    }
+
+    // tags are stored once in the index and referred to by position; tagIds maps dictionary to file identifiers
+    QCborArray entryToCbor(ProjectIndex::Entry const &entry, QHash<TagId, qint64> &tagIds, QCborArray &tags) {
+        QCborArray assignedTags;
+        for (auto const tag: entry.assignedTags) {
+            auto it = tagIds.find(tag);
+            if (it == tagIds.end()) {
+                it = tagIds.insert(tag, tags.size());
+                tags.append(TagDictionary::instance().tag(tag));
+            }
+            assignedTags.append(*it);
+        }
+
+        QCborValue region(QCborValue::Null);
+        if (entry.imageRegion)
+            region = QCborArray({
+                entry.imageRegion->left(), entry.imageRegion->top(), entry.imageRegion->right(), entry.imageRegion->bottom()
+            });
+
+        auto optionalUuid = [](std::optional<QUuid> const &uuid){
+            return uuid ? QCborValue(uuid->toRfc4122()) : QCborValue(QCborValue::Null);
+        };
+
+        return QCborArray({
+            entry.tagsFileModified,
+            entry.tagsFileSize,
+            assignedTags,
+            region,
+            entry.completeFlag,
+            optionalUuid(entry.tagLibraryUuid),
+            entry.tagLibraryVersion ? QCborValue(*entry.tagLibraryVersion) : QCborValue(QCborValue::Null),
+            optionalUuid(entry.tagLibraryVersionUuid)
+        });
+    }
+}
+
+ProjectIndex::ProjectIndex(QString const &indexFilePath, QString const &rootDir):
+    indexFilePath_(indexFilePath), rootDir_(rootDir) {}
+
+std::expected<void, QString> ProjectIndex::init() {
+    ZoneScoped;
+
+    QFile file(indexFilePath_);
+    if (!file.exists())
+        return {};
+
+    if (!file.open(QIODevice::ReadOnly))
+        return std::unexpected(QObject::tr("Could not open file for reading: %1 (%2)").arg(indexFilePath_, file.errorString()));
+
+    qDebug() << "Loading project index from" << indexFilePath_;
+
+    QCborStreamReader reader(&file);
+    auto map = QCborValue::fromCbor(reader).toMap();
+
+    auto formatVersion = map.value(std::to_underlying(Key::FORMAT_VERSION));
+    if (!formatVersion.isInteger() || formatVersion.toInteger() != valueFormatVersion)
+        return std::unexpected(QObject::tr("Missing or unknown format version"));
+
+    if (auto app = map.value(std::to_underlying(Key::APP)); app.toString() != valueApp.toString())
+        qWarning() << "Project index: unknown application value:" << app.toString();
+
+    auto tagsValue = map.value(std::to_underlying(Key::TAGS));
+    if (!tagsValue.isArray())
+        return std::unexpected(QObject::tr("Tags key is not an array but %1").arg(cborTypeToString(tagsValue.type())));
+
+    TagIdList tags;
+    for (auto const &tag: tagsValue.toArray()) {
+        if (!tag.isString())
+            return std::unexpected(QObject::tr("Tags element is not a string but %1").arg(cborTypeToString(tag.type())));
+        tags.append(TagDictionary::instance().intern(tag.toString()));
+    }
+
+    auto entries = map.value(std::to_underlying(Key::ENTRIES));
+    if (!entries.isMap())
+        return std::unexpected(QObject::tr("Entries key is not a map but %1").arg(cborTypeToString(entries.type())));
+
+    for (auto const &[path, value]: entries.toMap()) {
+        if (!path.isString() || !value.isArray())
+            return std::unexpected(QObject::tr("Invalid entry"));
+
+        if (auto entry = entryFromCbor(value.toArray(), tags); !entry)
+            return std::unexpected(QObject::tr("Invalid entry for %1: %2").arg(path.toString(), entry.error()));
+        else
+            entries_.insert(path.toString(), std::move(*entry));
+    }
+
+    qDebug() << "Loading project index done," << entries_.size() << "entries";
+    return {};
+}
+
+std::expected<std::unique_ptr<ProjectIndex>, QString> ProjectIndex::create(
+        QString const &indexFilePath, QString const &rootDir
+) {
+    ZoneScoped;
+
+    std::unique_ptr<ProjectIndex> self{new ProjectIndex(indexFilePath, rootDir)};
+    if (auto result = self->init(); !result) {
+        // index is only a cache, so it's fine to start over with an empty one
+        qWarning() << "Could not load project index" << indexFilePath << ":" << result.error() << "; starting with an empty index";
+        self->entries_.clear();
+        self->modified_ = true;
+    }
+
+    return self;
+}
+
+ProjectIndex::~ProjectIndex() = default;
+
+std::optional<ProjectIndex::Entry> ProjectIndex::find(QString const &imageFilePath, QFileInfo const &tagsFileInfo) const {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(imageFilePath).isAbsolute());
+
+    auto relative = QDir(rootDir_).relativeFilePath(imageFilePath);
+
+    QMutexLocker locker(&mutex_);
+
+    auto it = entries_.constFind(relative);
+    if (it == entries_.cend()
+        || it->tagsFileModified != tagsFileModified(tagsFileInfo)
+        || it->tagsFileSize != tagsFileSize(tagsFileInfo))
+        return std::nullopt;
+
+    return *it;
+}
+
+void ProjectIndex::update(QString const &imageFilePath, QFileInfo const &tagsFileInfo, Entry entry) {
+    ZoneScoped;
+    gsl_Expects(QFileInfo(imageFilePath).isAbsolute());
+
+    auto relative = QDir(rootDir_).relativeFilePath(imageFilePath);
+
+    entry.tagsFileModified = tagsFileModified(tagsFileInfo);
+    entry.tagsFileSize = tagsFileSize(tagsFileInfo);
+
+    QMutexLocker locker(&mutex_);
+    entries_.insert(relative, std::move(entry));
+    modified_ = true;
+}
+
+std::expected<void, QString> ProjectIndex::save() {
+    ZoneScoped;
+
+    QStringList paths;
+    {
+        QMutexLocker locker(&mutex_);
+        if (!modified_)
+            return {};
+        paths = entries_.keys();
+    }
+
+    // entries of images deleted since they were indexed are dropped; checked without the lock, as it's a stat each
+    QDir rootDir(rootDir_);
+    QStringList deleted;
+    for (auto const &path: paths)
+        if (!QFileInfo::exists(rootDir.filePath(path)))
+            deleted.append(path);
+
+    QMutexLocker locker(&mutex_);
+
+    for (auto const &path: deleted)
+        entries_.remove(path);
+
+    qDebug() << "Writing project index:" << indexFilePath_;
+
+    QSaveFile file(indexFilePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return std::unexpected(QObject::tr("Could not open file for writing: %1 (%2)").arg(indexFilePath_, file.errorString()));
+
+    QHash<TagId, qint64> tagIds;
+    QCborArray tags;
+    QCborMap entries;
+    for (auto const &[path, entry]: entries_.asKeyValueRange())
+        entries[path] = entryToCbor(entry, tagIds, tags);
+
+    QCborMap map;
+    map[std::to_underlying(Key::FORMAT_VERSION)] = valueFormatVersion;
+    map[std::to_underlying(Key::APP)] = valueApp.toString();
+    map[std::to_underlying(Key::TAGS)] = tags;
+    map[std::to_underlying(Key::ENTRIES)] = entries;
+
+    QCborStreamWriter writer(&file);
+    map.toCborValue().toCbor(writer);
+
+    if (!file.commit())
+        return std::unexpected(QObject::tr("Could not write file: %1 (%2)").arg(indexFilePath_, file.errorString()));
+
+    modified_ = false;
+
+    qDebug() << "Writing project index done";
+    return {};
+}
+
+int ProjectIndex::size() const {
+    QMutexLocker locker(&mutex_);
+    return entries_.size();
+}
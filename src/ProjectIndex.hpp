@@ -0,0 +1,69 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "TagDictionary.hpp"
+
+// Cache of per-image tag metadata for the whole project, stored in a single file next to the project file. Lets
+// FileTags skip parsing sidecar files that didn't change since they were last indexed.
+class ProjectIndex {
+    ProjectIndex(QString const &indexFilePath, QString const &rootDir);
+    [[nodiscard]] std::expected<void, QString> init();
+
+public:
+    ProjectIndex(ProjectIndex const &other) = delete;
+    ProjectIndex(ProjectIndex &&other) = delete;
+    ProjectIndex &operator=(ProjectIndex const &other) = delete;
+    ProjectIndex &operator=(ProjectIndex &&other) = delete;
+
+    [[nodiscard]] static std::expected<std::unique_ptr<ProjectIndex>, QString> create(
+            QString const &indexFilePath, QString const &rootDir
+    );
+    ~ProjectIndex();
+
+    struct Entry {
+        // state of the tags file at the moment of indexing; -1 if the tags file didn't exist
+        qint64 tagsFileModified = -1;
+        qint64 tagsFileSize = -1;
+
+        TagIdList assignedTags;
+        std::optional<QRect> imageRegion;
+        bool completeFlag = false;
+
+        std::optional<QUuid> tagLibraryUuid;
+        std::optional<int> tagLibraryVersion;
+        std::optional<QUuid> tagLibraryVersionUuid;
+    };
+
+    // all methods below are thread-safe
+
+    // returns entry only if the tags file is still in the same state as when it was indexed
+    [[nodiscard]] std::optional<Entry> find(QString const &imageFilePath, QFileInfo const &tagsFileInfo) const;
+    void update(QString const &imageFilePath, QFileInfo const &tagsFileInfo, Entry entry);
+
+    // writes the index if anything changed since it was loaded or saved, dropping entries of deleted images
+    [[nodiscard]] std::expected<void, QString> save();
+
+    [[nodiscard]] int size() const;
+
+private:
+    QString indexFilePath_;
+    QString rootDir_;
+
+    mutable QMutex mutex_;
+    QHash<QString, Entry> entries_;
+    bool modified_ = false;
+};
@@ -25,6 +25,10 @@ namespace Keys {
     }
     namespace System {
         static constexpr QAnyStringView BACKUP_ON_ANY_CHANGE = "settings_system_backup_on_any_change";
+        static constexpr QAnyStringView THUMBNAIL_CACHE_SIZE_MIB = "settings_system_thumbnail_cache_size_mib";
+        static constexpr QAnyStringView IMAGE_CACHE_SIZE_MIB = "settings_system_image_cache_size_mib";
+        static constexpr QAnyStringView FILE_TAGS_CACHE_SIZE_MIB = "settings_system_file_tags_cache_size_mib";
+        static constexpr QAnyStringView IMAGE_PREFETCH_COUNT = "settings_system_image_prefetch_count";
     }
 }
 
@@ -43,6 +47,10 @@ void Settings::load() {
     interface.imageFixedAspectRatios = settings.value(Keys::Interface::IMAGE_FIXED_ASPECT_RATIOS, interface.imageFixedAspectRatios).toBool();
 
     system.backupOnAnyChange = settings.value(Keys::System::BACKUP_ON_ANY_CHANGE, system.backupOnAnyChange_default).toBool();
+    system.thumbnailCacheSizeMiB = settings.value(Keys::System::THUMBNAIL_CACHE_SIZE_MIB, system.thumbnailCacheSizeMiB_default).toInt();
+    system.imageCacheSizeMiB = settings.value(Keys::System::IMAGE_CACHE_SIZE_MIB, system.imageCacheSizeMiB_default).toInt();
+    system.fileTagsCacheSizeMiB = settings.value(Keys::System::FILE_TAGS_CACHE_SIZE_MIB, system.fileTagsCacheSizeMiB_default).toInt();
+    system.imagePrefetchCount = settings.value(Keys::System::IMAGE_PREFETCH_COUNT, system.imagePrefetchCount_default).toInt();
 }
 
 void Settings::save() {
@@ -56,6 +64,10 @@ void Settings::save() {
     settings.setValue(Keys::Interface::IMAGE_FIXED_ASPECT_RATIOS, interface.imageFixedAspectRatios);
 
     settings.setValue(Keys::System::BACKUP_ON_ANY_CHANGE, system.backupOnAnyChange);
+    settings.setValue(Keys::System::THUMBNAIL_CACHE_SIZE_MIB, system.thumbnailCacheSizeMiB);
+    settings.setValue(Keys::System::IMAGE_CACHE_SIZE_MIB, system.imageCacheSizeMiB);
+    settings.setValue(Keys::System::FILE_TAGS_CACHE_SIZE_MIB, system.fileTagsCacheSizeMiB);
+    settings.setValue(Keys::System::IMAGE_PREFETCH_COUNT, system.imagePrefetchCount);
 }
 
 QString Settings::Interface::language_default() {
@@ -53,5 +53,17 @@ public:
     struct System {
         static constexpr bool backupOnAnyChange_default = false;
         bool backupOnAnyChange = backupOnAnyChange_default;
+
+        static constexpr int thumbnailCacheSizeMiB_default = 256;
+        int thumbnailCacheSizeMiB = thumbnailCacheSizeMiB_default;
+
+        static constexpr int imageCacheSizeMiB_default = 512;
+        int imageCacheSizeMiB = imageCacheSizeMiB_default;
+
+        static constexpr int fileTagsCacheSizeMiB_default = 64;
+        int fileTagsCacheSizeMiB = fileTagsCacheSizeMiB_default;
+
+        static constexpr int imagePrefetchCount_default = 2;
+        int imagePrefetchCount = imagePrefetchCount_default;
     } system;
 };
@@ -57,6 +57,22 @@ SettingsDialog::SettingsDialog(Settings const &settings, QWidget *parent, Qt::Wi
     connect(ui->checkBoxBackupOnAnyChange, &QCheckBox::checkStateChanged, this, [this](Qt::CheckState const value){
         settings_.system.backupOnAnyChange = (value == Qt::CheckState::Checked);
     });
+    ui->spinBoxThumbnailCacheSize->setValue(settings_.system.thumbnailCacheSizeMiB);
+    connect(ui->spinBoxThumbnailCacheSize, &QSpinBox::valueChanged, this, [this](int const value){
+        settings_.system.thumbnailCacheSizeMiB = value;
+    });
+    ui->spinBoxImageCacheSize->setValue(settings_.system.imageCacheSizeMiB);
+    connect(ui->spinBoxImageCacheSize, &QSpinBox::valueChanged, this, [this](int const value){
+        settings_.system.imageCacheSizeMiB = value;
+    });
+    ui->spinBoxFileTagsCacheSize->setValue(settings_.system.fileTagsCacheSizeMiB);
+    connect(ui->spinBoxFileTagsCacheSize, &QSpinBox::valueChanged, this, [this](int const value){
+        settings_.system.fileTagsCacheSizeMiB = value;
+    });
+    ui->spinBoxImagePrefetchCount->setValue(settings_.system.imagePrefetchCount);
+    connect(ui->spinBoxImagePrefetchCount, &QSpinBox::valueChanged, this, [this](int const value){
+        settings_.system.imagePrefetchCount = value;
+    });
 }
 
 SettingsDialog::~SettingsDialog() = default;
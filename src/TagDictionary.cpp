@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "TagDictionary.hpp"
+
+TagDictionary &TagDictionary::instance() {
+    static TagDictionary dictionary;
+    return dictionary;
+}
+
+TagId TagDictionary::intern(QString const &tag) {
+    {
+        QReadLocker locker(&lock_);
+        if (auto it = ids_.constFind(tag); it != ids_.cend())
+            return *it;
+    }
+
+    QWriteLocker locker(&lock_);
+
+    // might have been added between the locks
+    if (auto it = ids_.constFind(tag); it != ids_.cend())
+        return *it;
+
+    gsl_Assert(tags_.size() < std::numeric_limits<TagId>::max());
+    auto id = static_cast<TagId>(tags_.size());
+    tags_.append(tag);
+    ids_.insert(tag, id);
+    return id;
+}
+
+TagIdList TagDictionary::intern(QStringList const &tags) {
+    ZoneScoped;
+
+    TagIdList result;
+    result.reserve(tags.size());
+    for (auto const &tag: tags)
+        result.append(intern(tag));
+    return result;
+}
+
+std::optional<TagId> TagDictionary::find(QString const &tag) const {
+    QReadLocker locker(&lock_);
+    if (auto it = ids_.constFind(tag); it != ids_.cend())
+        return *it;
+    else
+        return std::nullopt;
+}
+
+QString TagDictionary::tag(TagId const id) const {
+    QReadLocker locker(&lock_);
+    gsl_Expects(id < static_cast<TagId>(tags_.size()));
+    return tags_.at(id);
+}
+
+QStringList TagDictionary::tags(TagIdList const &ids) const {
+    ZoneScoped;
+
+    QReadLocker locker(&lock_);
+
+    QStringList result;
+    result.reserve(ids.size());
+    for (auto const id: ids) {
+        gsl_Expects(id < static_cast<TagId>(tags_.size()));
+        result.append(tags_.at(id));
+    }
+    return result;
+}
+
+int TagDictionary::size() const {
+    QReadLocker locker(&lock_);
+    return static_cast<int>(tags_.size());
+}
@@ -0,0 +1,52 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+using TagId = quint32;
+using TagIdList = QList<TagId>;
+
+// Process-wide dictionary of interned tags. Every distinct (resolved) tag string gets a compact identifier, so that
+// tags can be stored and compared as integers; strings are only needed for display and serialization. Identifiers are
+// never released, so they stay valid for the whole process lifetime. All methods are thread-safe.
+class TagDictionary {
+    TagDictionary() = default;
+
+public:
+    TagDictionary(TagDictionary const &other) = delete;
+    TagDictionary(TagDictionary &&other) = delete;
+    TagDictionary &operator=(TagDictionary const &other) = delete;
+    TagDictionary &operator=(TagDictionary &&other) = delete;
+
+    [[nodiscard]] static TagDictionary &instance();
+
+    // returns identifier of the tag, adding it to the dictionary if necessary
+    [[nodiscard]] TagId intern(QString const &tag);
+    [[nodiscard]] TagIdList intern(QStringList const &tags);
+
+    // returns identifier of the tag only if it's been interned already
+    [[nodiscard]] std::optional<TagId> find(QString const &tag) const;
+
+    [[nodiscard]] QString tag(TagId id) const;
+    [[nodiscard]] QStringList tags(TagIdList const &ids) const;
+
+    [[nodiscard]] int size() const;
+
+private:
+    mutable QReadWriteLock lock_;
+    QHash<QString, TagId> ids_;
+    QStringList tags_;
+};
@@ -28,6 +28,17 @@ enum class TopLevelKey {
     LibraryVersionUuid = 6
 };
 
+// Journal is a sequence of top-level maps, one per save, each holding the nodes changed by that save. Nodes are saved
+// shallowly: children are referenced by their UUIDs, so that they're resolved against the library and the preceding
+// journal entries on load.
+enum class JournalKey {
+    BaseVersionUuid = 1, // library version the entry applies to
+    LibraryVersion = 2,
+    LibraryVersionUuid = 3,
+    RootUuid = 4,
+    Nodes = 5
+};
+
 constexpr unsigned int formatVersion = 1;
 static constexpr QAnyStringView app = "SIMPLETAGGER-CXX";
 
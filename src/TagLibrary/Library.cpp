@@ -529,7 +529,7 @@ std::expected<void, QString> Library::init() {
         info += tr("<b>Library path: </b> %1<br>").arg(libraryPath_);
         info += tr("<b>Library UUID: </b> %1<br>").arg(libraryUuid_.toString(QUuid::WithoutBraces));
         info += tr("<b>Library version: </b> %1 (<small>%2</small>)<br>").arg(currentLibraryVersion_).arg(currentLibraryVersionUuid_.toString(QUuid::WithoutBraces));
-        info += tr("<b>Tags count: </b> %1<br>").arg(allTags().size());
+        info += tr("<b>Distinct tags: </b> %1<br>").arg(allTags().size());
 
         LibraryInfoDialog libraryInfoDialog(info, this);
         libraryInfoDialog.exec();
@@ -594,6 +594,10 @@ QUuid Library::getVersionUuid() const {
     return currentLibraryVersionUuid_;
 }
 
+Model &Library::model() {
+    return *libraryModel_;
+}
+
 std::expected<void, QString> Library::saveContent(QIODevice &io) {
     ZoneScoped;
     gsl_Expects(!libraryUuid_.isNull());
@@ -621,42 +625,143 @@ std::expected<void, QString> Library::saveContent(QIODevice &io) {
 
     updateLibraryVersion(nextLibraryVersion_);
     currentLibraryVersionUuid_ = nextLibraryVersionUuid;
+    libraryModel_->clearChangedNodes();
+
+    return {};
+}
+
+std::expected<void, QString> Library::saveJournal(QIODevice &io) {
+    ZoneScoped;
+    gsl_Expects(!libraryUuid_.isNull());
+
+    auto nodes = libraryModel_->saveChangedNodes();
+    if (!nodes)
+        return std::unexpected(nodes.error());
+
+    // an entry without nodes would only bump the version
+    if (nodes->isEmpty())
+        return {};
+
+    auto nextLibraryVersionUuid = QUuid::createUuid();
+
+    QCborMap entry;
+    entry[std::to_underlying(Format::JournalKey::BaseVersionUuid)] = currentLibraryVersionUuid_.toRfc4122();
+    entry[std::to_underlying(Format::JournalKey::LibraryVersion)] = nextLibraryVersion_;
+    entry[std::to_underlying(Format::JournalKey::LibraryVersionUuid)] = nextLibraryVersionUuid.toRfc4122();
+    entry[std::to_underlying(Format::JournalKey::RootUuid)] = libraryModel_->rootUuid().toRfc4122();
+    entry[std::to_underlying(Format::JournalKey::Nodes)] = *nodes;
+
+    if (!io.open(QIODevice::WriteOnly | QIODevice::Append))
+        return std::unexpected(tr("Cannot open for writing: %1").arg(io.errorString()));
+
+    // written at once, so that an interrupted save leaves at most one truncated entry at the end
+    auto data = entry.toCborValue().toCbor();
+    if (io.write(data) != data.size())
+        return std::unexpected(tr("Cannot write: %1").arg(io.errorString()));
+    io.close();
+
+    updateLibraryVersion(nextLibraryVersion_);
+    currentLibraryVersionUuid_ = nextLibraryVersionUuid;
+    libraryModel_->clearChangedNodes();
 
     return {};
 }
 
-std::expected<void, QString> Library::loadContent(QIODevice &io) {
+std::expected<void, QString> Library::loadContent(QIODevice &io, QIODevice *journal) {
     ZoneScoped;
 
     if (!io.open(QIODevice::ReadOnly))
         return std::unexpected(tr("Cannot open for reading: %1").arg(io.errorString()));
 
+    QList<QCborMap> journalEntries;
+    if (journal) {
+        if (!journal->open(QIODevice::ReadOnly))
+            return std::unexpected(tr("Cannot open journal for reading: %1").arg(journal->errorString()));
+
+        QCborStreamReader journalReader(journal);
+        while (journalReader.isValid()) {
+            auto entry = QCborValue::fromCbor(journalReader);
+            if (journalReader.lastError() != QCborError::NoError || !entry.isMap()) {
+                // most likely the last save has been interrupted; everything before it is still valid
+                qCWarning(LoggingCategory) << "Ignoring malformed journal entry" << journalEntries.size() << "and the rest of the journal:"
+                        << journalReader.lastError().toString();
+                break;
+            }
+            journalEntries.append(entry.toMap());
+        }
+    }
+
+    // The root node makes up nearly all of the content, so it's loaded straight from the stream, without building its
+    // whole CBOR tree first. Remaining top-level elements are small and collected into a map.
     QCborStreamReader reader(&io);
-    auto content = QCborValue::fromCbor(reader);
-    if (!content.isMap())
+    if (!reader.isMap())
         return std::unexpected(tr("Content is not a map"));
+    if (!reader.enterContainer())
+        return std::unexpected(reader.lastError().toString());
 
-    auto map = content.toMap();
+    QCborMap map;
+
+    auto checkFormat = [&]() -> std::expected<void, QString> {
+        auto formatVersion = map.take(std::to_underlying(Format::TopLevelKey::FormatVersion));
+        if (formatVersion.isUndefined())
+            return std::unexpected(tr("Missing format version"));
+        if (!formatVersion.isInteger())
+            return std::unexpected(tr("Format version is not an integer, but %1").arg(cborTypeToString(formatVersion.type())));
+        if (formatVersion.toInteger() != Format::formatVersion)
+            return std::unexpected(tr("Unknown format version: %1").arg(QString::number(formatVersion.toInteger())));
+
+        auto app = map.take(std::to_underlying(Format::TopLevelKey::App));
+        if (app.isUndefined())
+            return std::unexpected(tr("Application key doesn't exist"));
+        if (!app.isString())
+            return std::unexpected(tr("Application key is not a string but %1").arg(cborTypeToString(app.type())));
+        if (app.toString() != Format::app)
+            qCWarning(LoggingCategory) << "Unknown application value:" << app.toString();
+
+        return {};
+    };
 
-    auto formatVersion = map.take(std::to_underlying(Format::TopLevelKey::FormatVersion));
-    if (formatVersion.isUndefined())
-        return std::unexpected(tr("Missing format version"));
-    if (!formatVersion.isInteger())
-        return std::unexpected(tr("Format version is not an integer, but %1").arg(cborTypeToString(formatVersion.type())));
-    if (formatVersion.toInteger() != Format::formatVersion)
-        return std::unexpected(tr("Unknown format version: %1").arg(QString::number(formatVersion.toInteger())));
+    bool formatChecked = false;
+    bool rootLoaded = false;
+    while (reader.hasNext()) {
+        auto key = QCborValue::fromCbor(reader);
+        if (reader.lastError() != QCborError::NoError)
+            return std::unexpected(reader.lastError().toString());
+
+        // the format has to be known before the root node can be interpreted, which is always the case for
+        // content we save; anything else, or a journal to replay, falls back to loading the root node from the map
+        if (key.isInteger() && key.toInteger() == std::to_underlying(Format::TopLevelKey::RootNode) && !rootLoaded
+                && journalEntries.empty()
+                && map.contains(std::to_underlying(Format::TopLevelKey::FormatVersion))
+                && map.contains(std::to_underlying(Format::TopLevelKey::App))) {
+            if (auto result = checkFormat(); !result)
+                return result;
+            formatChecked = true;
+
+            if (auto result = libraryModel_->load(reader); !result)
+                return std::unexpected(result.error());
+            rootLoaded = true;
+        } else {
+            map.insert(key, QCborValue::fromCbor(reader));
+        }
+
+        if (reader.lastError() != QCborError::NoError)
+            return std::unexpected(reader.lastError().toString());
+    }
+    if (!reader.leaveContainer())
+        return std::unexpected(reader.lastError().toString());
 
-    auto app = map.take(std::to_underlying(Format::TopLevelKey::App));
-    if (app.isUndefined())
-        return std::unexpected(tr("Application key doesn't exist"));
-    if (!app.isString())
-        return std::unexpected(tr("Application key is not a string but %1").arg(cborTypeToString(app.type())));
-    if (app.toString() != Format::app)
-        qCWarning(LoggingCategory) << "Unknown application value:" << app.toString();
+    if (!formatChecked) {
+        if (auto result = checkFormat(); !result)
+            return result;
+    }
 
-    auto root = map.take(std::to_underlying(Format::TopLevelKey::RootNode));
-    if (root.isUndefined())
-        return std::unexpected(tr("Root node not found"));
+    QCborValue root;
+    if (!rootLoaded) {
+        root = map.take(std::to_underlying(Format::TopLevelKey::RootNode));
+        if (root.isUndefined())
+            return std::unexpected(tr("Root node not found"));
+    }
 
     auto libraryUuid = map.take(std::to_underlying(Format::TopLevelKey::LibraryUuid));
     if (libraryUuid.isUndefined())
@@ -682,8 +787,20 @@ std::expected<void, QString> Library::loadContent(QIODevice &io) {
     for (auto const &v: map)
         qCWarning(LoggingCategory) << "Unhandled element" << v.first << "=" << v.second;
 
-    if (auto result = libraryModel_->load(root); !result)
-        return std::unexpected(result.error());
+    if (!rootLoaded) {
+        if (!journalEntries.empty()) {
+            if (auto result = replayJournal(root, journalEntries); !result)
+                return std::unexpected(result.error());
+            else
+                root = std::move(*result);
+        }
+
+        if (auto result = libraryModel_->load(root); !result)
+            return std::unexpected(result.error());
+    }
+
+    // model load is performed with signals blocked, notify listeners about the whole new content
+    emit contentChanged();
 
     return {};
 }
@@ -792,6 +909,98 @@ QModelIndex Library::toViewModelIndex(QModelIndex const &libraryModelIndex) cons
     return model_->mapFromSource(filterModelIndex);
 }
 
+std::expected<QCborValue, QString> Library::replayJournal(QCborValue const &root, QList<QCborMap> const &entries) {
+    ZoneScoped;
+
+    auto uuidKey = std::to_underlying(Format::NodeKey::Uuid);
+    auto childrenKey = std::to_underlying(Format::NodeKey::Children);
+
+    // flatten the tree into shallow nodes, the same as in the journal
+    QHash<QByteArray, QCborMap> nodes;
+    auto flatten = [&](this auto const &self, QCborValue const &value) -> std::expected<QByteArray, QString> {
+        auto map = value.toMap();
+        auto uuid = map.value(uuidKey);
+        if (!uuid.isByteArray())
+            return std::unexpected(tr("UUID element is not a byte array but %1").arg(cborTypeToString(uuid.type())));
+
+        if (map.contains(childrenKey)) {
+            QCborArray children;
+            for (auto const &child: map.value(childrenKey).toArray()) {
+                if (auto childUuid = self(child); !childUuid)
+                    return childUuid;
+                else
+                    children.append(*childUuid);
+            }
+            map[childrenKey] = children;
+        }
+
+        nodes.insert(uuid.toByteArray(), map);
+        return uuid.toByteArray();
+    };
+
+    auto rootUuid = flatten(root);
+    if (!rootUuid)
+        return std::unexpected(rootUuid.error());
+
+    for (auto const &entry: entries) {
+        // an entry not following the current version was saved against a different library file, e.g. before the
+        // library has been rewritten
+        auto baseVersionUuid = entry.value(std::to_underlying(Format::JournalKey::BaseVersionUuid));
+        if (!baseVersionUuid.isByteArray() || QUuid::fromRfc4122(baseVersionUuid.toByteArray()) != currentLibraryVersionUuid_) {
+            qCWarning(LoggingCategory) << "Journal doesn't continue library version" << currentLibraryVersionUuid_ << ", ignoring rest of it";
+            break;
+        }
+
+        auto libraryVersion = entry.value(std::to_underlying(Format::JournalKey::LibraryVersion));
+        if (!libraryVersion.isInteger())
+            return std::unexpected(tr("Journal library version is not an integer but %1").arg(cborTypeToString(libraryVersion.type())));
+        auto libraryVersionUuid = entry.value(std::to_underlying(Format::JournalKey::LibraryVersionUuid));
+        if (!libraryVersionUuid.isByteArray())
+            return std::unexpected(tr("Journal library version UUID is not a byte array but %1").arg(cborTypeToString(libraryVersionUuid.type())));
+        auto entryRootUuid = entry.value(std::to_underlying(Format::JournalKey::RootUuid));
+        if (!entryRootUuid.isByteArray())
+            return std::unexpected(tr("Journal root UUID is not a byte array but %1").arg(cborTypeToString(entryRootUuid.type())));
+
+        for (auto const &node: entry.value(std::to_underlying(Format::JournalKey::Nodes)).toArray()) {
+            auto uuid = node.toMap().value(uuidKey);
+            if (!uuid.isByteArray())
+                return std::unexpected(tr("Journal node UUID is not a byte array but %1").arg(cborTypeToString(uuid.type())));
+            nodes.insert(uuid.toByteArray(), node.toMap());
+        }
+
+        *rootUuid = entryRootUuid.toByteArray();
+        updateLibraryVersion(libraryVersion.toInteger());
+        currentLibraryVersionUuid_ = QUuid::fromRfc4122(libraryVersionUuid.toByteArray());
+    }
+
+    // nodes removed since the library has been saved aren't referenced anymore, and are dropped here
+    QSet<QByteArray> visited;
+    auto assemble = [&](this auto const &self, QByteArray const &uuid) -> std::expected<QCborValue, QString> {
+        auto node = nodes.find(uuid);
+        if (node == nodes.end())
+            return std::unexpected(tr("Journal references unknown node %1").arg(QUuid::fromRfc4122(uuid).toString()));
+        if (visited.contains(uuid))
+            return std::unexpected(tr("Journal references node %1 more than once").arg(QUuid::fromRfc4122(uuid).toString()));
+        visited.insert(uuid);
+
+        auto map = *node;
+        if (map.contains(childrenKey)) {
+            QCborArray children;
+            for (auto const &childUuid: map.value(childrenKey).toArray()) {
+                if (auto child = self(childUuid.toByteArray()); !child)
+                    return child;
+                else
+                    children.append(*child);
+            }
+            map[childrenKey] = children;
+        }
+
+        return map;
+    };
+
+    return assemble(*rootUuid);
+}
+
 void Library::updateLibraryVersion(int const currentLibraryVersion) {
     currentLibraryVersion_ = currentLibraryVersion;
     nextLibraryVersion_ = currentLibraryVersion + 1;
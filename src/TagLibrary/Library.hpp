@@ -51,9 +51,15 @@ public:
     [[nodiscard]] QUuid getUuid() const;
     [[nodiscard]] int getVersion() const;
     [[nodiscard]] QUuid getVersionUuid() const;
+    // model of the whole content, without any of the view's filtering
+    [[nodiscard]] Model &model();
 
     [[nodiscard]] std::expected<void, QString> saveContent(QIODevice &io);
-    [[nodiscard]] std::expected<void, QString> loadContent(QIODevice &io);
+    // Appends the changes since the last save to the journal, see Format::JournalKey. Cost depends only on the number
+    // of changed nodes, but the journal has to be passed to every following loadContent(). Nothing is appended, and
+    // the version stays, when nothing has changed.
+    [[nodiscard]] std::expected<void, QString> saveJournal(QIODevice &io);
+    [[nodiscard]] std::expected<void, QString> loadContent(QIODevice &io, QIODevice *journal = nullptr);
 
     [[nodiscard]] QByteArray saveUiState() const;
     void restoreUiState(QByteArray const &value);
@@ -79,6 +85,7 @@ private:
     QModelIndex toLibraryModelIndex(QModelIndex const &viewModelIndex) const;
     QModelIndex toViewModelIndex(QModelIndex const &libraryModelIndex) const;
     void updateLibraryVersion(int currentLibraryVersion);
+    [[nodiscard]] std::expected<QCborValue, QString> replayJournal(QCborValue const &root, QList<QCborMap> const &entries);
 
     std::unique_ptr<Ui_Library> ui;
     std::unique_ptr<Model> libraryModel_;
@@ -18,18 +18,15 @@
 
 #include "Logging.hpp"
 #include "NodeHierarchical.hpp"
+#include "NodeLink.hpp"
 #include "NodeRoot.hpp"
+#include "NodeShadow.hpp"
 
 #include "../CustomItemDataRole.hpp"
 #include "../Utility.hpp"
 
 namespace TagLibrary {
-Model::Model() {
-    connect(this, &Model::persistentDataChanged, this, [this]{
-        if (auto result = invalidateTagCaches(); !result)
-            reportError(QObject::tr("Tags cache invalidation failed"), result.error());
-    });
-}
+Model::Model() = default;
 
 Model::~Model() {
     root->deinit();
@@ -150,6 +147,14 @@ int Model::recursiveRowCount(const QModelIndex &parent) const {
     ZoneScoped;
     gsl_Expects(!parent.isValid() || parent.model() == this);
 
+    // subtree aggregates enumerate the children the same way as rows are in edit mode
+    if (editMode_ && parent.column() <= 0) {
+        if (auto node = fromIndex(parent))
+            return node->subtreeAggregates().descendantsCount;
+        else
+            return 0;
+    }
+
     int directCount = rowCount(parent);
     int count = directCount;
 
@@ -678,8 +683,43 @@ std::expected<QCborValue, QString> Model::save() const {
     return root->save();
 }
 
+std::expected<QCborArray, QString> Model::saveChangedNodes() const {
+    ZoneScoped;
+
+    QCborArray nodes;
+    for (auto const &weakNode: changedNodes_) {
+        if (auto node = weakNode.lock()) {
+            if (auto value = node->save(NodeSerializable::SaveMode::Shallow))
+                nodes.append(*value);
+            else
+                return std::unexpected(value.error());
+        }
+    }
+
+    return nodes;
+}
+
+void Model::clearChangedNodes() {
+    changedNodes_.clear();
+}
+
+QUuid Model::rootUuid() const {
+    return root->uuid();
+}
+
 std::expected<void, QString> Model::load(QCborValue const &value) {
     ZoneScoped;
+    return replaceRoot([&]{ return NodeHierarchical::load(value, *this, nullptr); });
+}
+
+std::expected<void, QString> Model::load(QCborStreamReader &reader) {
+    ZoneScoped;
+    return replaceRoot([&]{ return NodeHierarchical::load(reader, *this, nullptr); });
+}
+
+template<typename Loader>
+std::expected<void, QString> Model::replaceRoot(Loader const &loader) {
+    ZoneScoped;
 
     beginResetModel();
     auto _ = gsl::finally([this]{ endResetModel(); });
@@ -687,7 +727,7 @@ std::expected<void, QString> Model::load(QCborValue const &value) {
     {
         // prevent signals like insertChildrenBegin/End to be emitted
         QSignalBlocker block(this);
-        auto result = NodeHierarchical::load(value, *this, nullptr);
+        auto result = loader();
         if (!result)
             return std::unexpected(result.error());
 
@@ -702,6 +742,9 @@ std::expected<void, QString> Model::load(QCborValue const &value) {
 
         if (auto result = root->populateShadows(); !result)
             return std::unexpected(result.error());
+
+        // everything has just been loaded, so nothing is changed yet
+        clearChangedNodes();
     }
 
     emit loadComplete();
@@ -743,50 +786,65 @@ bool Model::editMode() const {
 std::expected<void, QString> Model::setTagsActive(QStringList const &tags) {
     ZoneScoped;
 
-    std::expected<void, QString> result;
-
+    QHash<Node const *, std::shared_ptr<Node>> toActivate;
     {
-        QSignalBlocker blocker(*this);
+        QMutexLocker locker(&allTagsMutex_);
 
-        if (auto result = root->visit(
-                Node::VisitFlag::Recursive,
-                [&](auto &&node) -> std::expected<bool, Error> {
-            ZoneScoped;
-
-            if (node->canSetActive()) {
-                bool active = false;
-
-                for (auto const &tag: tags) {
-                    if (std::ranges::any_of(
-                            node->tags(Node::TagFlag::IncludeResolved),
-                            [&](auto const &nodeTag) { return nodeTag.resolved == tag; }
-                    )) {
-                        active = true;
-                        break;
-                    }
+        if (auto result = updateTagAggregates_(); !result)
+            return std::unexpected(result.error());
+
+        for (auto const &tag: tags) {
+            // a tag that was never interned can't belong to any node
+            auto id = TagDictionary::instance().find(tag);
+            if (!id)
+                continue;
+
+            if (auto it = tagIndex_.find(*id); it != tagIndex_.end()) {
+                for (auto const &weakNode: *it) {
+                    if (auto node = weakNode.lock())
+                        toActivate.emplace(&*node, std::move(node));
                 }
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<Node>> changed;
+
+    {
+        QSignalBlocker blocker(*this);
 
-                if (auto result = node->setActive(active); !result)
-                    return std::unexpected(result.error());
+        // copied, as setActive() modifies activeNodes_ through nodeActiveChanged()
+        auto previouslyActive = activeNodes_;
+        for (auto const &[key, weakNode]: previouslyActive.asKeyValueRange()) {
+            auto node = weakNode.lock();
+            if (!node) {
+                activeNodes_.remove(key);
+                continue;
             }
 
-            return true;
-        }); !result)
-            return std::unexpected(result.error());
+            if (toActivate.contains(key) || !node->canSetActive())
+                continue;
+
+            if (auto result = node->setActive(false); !result)
+                return std::unexpected(result.error());
+            changed.push_back(std::move(node));
+        }
+
+        for (auto const &node: toActivate) {
+            if (auto active = node->active(); active && *active)
+                continue;
+
+            if (auto result = node->setActive(true); !result)
+                return std::unexpected(result.error());
+            changed.push_back(node);
+        }
     }
 
-    // potentially many tags might be modified in this function, that's why we block signals for the time of
-    // visit and only fire dataChanged here
-    if (auto result = root->visit(
-            Node::VisitFlag::ExcludeSelf,
-            [&](auto &&node) -> std::expected<bool, Error> {
-        ZoneScoped;
-        emit dataChanged(toIndex(node), toIndex(node));
-        return true;
-    }); !result)
-        return std::unexpected(result.error());
+    // potentially many nodes might be modified in this function, that's why we block signals for the time of
+    // modification and only fire (coalesced) dataChanged here
+    emitActiveDataChanged(changed);
 
-    return result;
+    return {};
 }
 
 void Model::setRowHeight(int const rowHeight) {
@@ -836,7 +894,18 @@ void Model::setNextLibraryVersion(int const nextVersion) {
 }
 
 std::expected<void, Error> Model::invalidateTagCaches() const {
+    ZoneScoped;
+
+    QMutexLocker locker(&allTagsMutex_);
+
+    tagsScanned_ = false;
+    dirtyTagNodes_.clear();
+    nodeTags_.clear();
+    tagCounts_.clear();
+    tagOrder_.clear();
     allTags_ = std::nullopt;
+    tagIndex_.clear();
+
     if (auto result = root->visit(Node::VisitFlag::Recursive, [](auto &&node)->std::expected<bool, Error>{
         node->invalidateTagCache();
         return true;
@@ -846,6 +915,38 @@ std::expected<void, Error> Model::invalidateTagCaches() const {
         return {};
 }
 
+void Model::invalidateTagCaches(Node &node) const {
+    ZoneScoped;
+
+    QMutexLocker locker(&allTagsMutex_);
+
+    // nodes whose own tags might have changed; their descendants resolve tags through them, so each brings its whole
+    // subtree along
+    std::vector<std::shared_ptr<Node>> pending{node.shared_from_this()};
+    QSet<Node const *> invalidated;
+
+    while (!pending.empty()) {
+        auto changed = std::move(pending.back());
+        pending.pop_back();
+
+        if (auto result = changed->visit(Node::VisitFlag::Recursive, [&](auto const &subtreeNode)->std::expected<bool, Error>{
+            if (invalidated.contains(&*subtreeNode))
+                return true;
+            invalidated.insert(&*subtreeNode);
+
+            subtreeNode->invalidateTagCache();
+            markTagsDirty_(subtreeNode);
+
+            for (auto const &weakDependent: tagDependents_.value(&*subtreeNode))
+                if (auto dependent = weakDependent.lock(); dependent && !invalidated.contains(&*dependent))
+                    pending.push_back(std::move(dependent));
+
+            return true;
+        }); !result)
+            reportError("invalidateTagCaches visit", result.error(), false);
+    }
+}
+
 QStringList Model::allTags() const {
     // TODO: this mutex only protects against multiple threads calling allTags().
     //       it doesn't however protect against a situation where on thread calls allTags()
@@ -858,17 +959,12 @@ QStringList Model::allTags() const {
     //       method would ensure appropriate mutexes are locked in right places.
     QMutexLocker locker(&allTagsMutex_);
 
-    if (!allTags_) {
-        allTags_.emplace();
-        if (auto result = root->visit(Node::VisitFlag::Recursive, [&](auto const &node)mutable->std::expected<bool, Error>{
-            std::ranges::copy(
-                    node->tags() | std::views::transform([](auto const &tag){ return tag.resolved; }),
-                    std::back_inserter(*allTags_)
-            );
+    if (auto result = updateTagAggregates_(); !result)
+        reportError("allTags update", result.error(), false);
 
-            return true;
-        }); !result)
-            reportError("allTags visit", result.error(), false);
+    if (!allTags_) {
+        compactTagOrder_();
+        allTags_ = TagDictionary::instance().tags(tagOrder_);
     }
     return *allTags_;
 }
@@ -922,4 +1018,170 @@ void Model::nodeUUIDUnregister(std::shared_ptr<Node> const &node) {
         }
     }
 }
+
+void Model::nodeActiveChanged(std::shared_ptr<Node> const &node, bool const active) {
+    if (active)
+        activeNodes_.insert(&*node, node);
+    else
+        activeNodes_.remove(&*node);
+}
+
+void Model::nodeTagsDependOn(std::shared_ptr<Node> const &node, Node const *dependency) {
+    if (auto previous = tagDependencies_.take(&*node)) {
+        if (auto it = tagDependents_.find(previous); it != tagDependents_.end()) {
+            it->remove(&*node);
+            if (it->isEmpty())
+                tagDependents_.erase(it);
+        }
+    }
+
+    if (dependency) {
+        tagDependencies_.insert(&*node, dependency);
+        tagDependents_[dependency].insert(&*node, node);
+    }
+}
+
+void Model::nodePersistentDataChanged(std::shared_ptr<Node> const &node) {
+    // shadows mirror other nodes and are never saved
+    if (auto serializable = std::dynamic_pointer_cast<NodeSerializable>(node))
+        changedNodes_.insert(&*node, serializable);
+}
+
+void Model::nodeChildrenChanged(std::shared_ptr<Node> const &node) {
+    // children of links are their shadows, links are saved without them
+    if (!std::dynamic_pointer_cast<NodeLink>(node))
+        nodePersistentDataChanged(node);
+}
+
+void Model::nodeTagsAdded(std::shared_ptr<Node> const &node) {
+    // shadow roots are not reachable in the tree, their links report the tags instead
+    if (auto shadow = std::dynamic_pointer_cast<NodeShadow const>(node); shadow && shadow->isShadowRoot())
+        return;
+
+    QMutexLocker locker(&allTagsMutex_);
+    markTagsDirty_(node);
+}
+
+void Model::nodeTagsRemoved(std::shared_ptr<Node> const &node) {
+    nodeTagsDependOn(node, nullptr);
+    tagDependents_.remove(&*node);
+
+    QMutexLocker locker(&allTagsMutex_);
+    dirtyTagNodes_.remove(&*node);
+    removeNodeTags_(&*node);
+}
+
+void Model::markTagsDirty_(std::shared_ptr<Node> const &node) const {
+    if (tagsScanned_)
+        dirtyTagNodes_.insert(&*node, node);
+}
+
+std::expected<void, Error> Model::updateTagAggregates_() const {
+    ZoneScoped;
+
+    if (!tagsScanned_) {
+        if (auto result = root->visit(Node::VisitFlag::Recursive, [&](auto const &node)->std::expected<bool, Error>{
+            addNodeTags_(node);
+            return true;
+        }); !result)
+            return std::unexpected(result.error());
+
+        tagsScanned_ = true;
+        dirtyTagNodes_.clear();
+        return {};
+    }
+
+    for (auto const &[key, weakNode]: dirtyTagNodes_.asKeyValueRange()) {
+        removeNodeTags_(key);
+        if (auto node = weakNode.lock(); node && !node->deinitialized())
+            addNodeTags_(node);
+    }
+    dirtyTagNodes_.clear();
+
+    return {};
+}
+
+void Model::compactTagOrder_() const {
+    QSet<TagId> seen;
+    seen.reserve(tagCounts_.size());
+    tagOrder_.removeIf([&](TagId const id){
+        if (!tagCounts_.contains(id) || seen.contains(id))
+            return true;
+        seen.insert(id);
+        return false;
+    });
+}
+
+void Model::addNodeTags_(std::shared_ptr<Node> const &node) const {
+    auto ids = TagDictionary::instance().intern(
+            node->tags(Node::TagFlag::IncludeResolved)
+            | std::views::transform([](auto const &tag){ return tag.resolved; })
+            | std::ranges::to<QStringList>()
+    );
+    if (ids.isEmpty())
+        return;
+
+    bool canSetActive = node->canSetActive();
+    for (auto const id: ids) {
+        if (tagCounts_[id]++ == 0) {
+            // tags removed and added back repeatedly would otherwise pile up until the next allTags()
+            if (tagOrder_.size() > 2 * tagCounts_.size())
+                compactTagOrder_();
+            tagOrder_.append(id);
+            allTags_ = std::nullopt;
+        }
+        if (canSetActive)
+            tagIndex_[id].insert(&*node, node);
+    }
+    nodeTags_.insert(&*node, std::move(ids));
+}
+
+void Model::removeNodeTags_(Node const *const node) const {
+    auto ids = nodeTags_.take(node);
+    for (auto const id: ids) {
+        if (auto it = tagCounts_.find(id); it != tagCounts_.end() && --*it == 0) {
+            tagCounts_.erase(it);
+            allTags_ = std::nullopt;
+        }
+        if (auto it = tagIndex_.find(id); it != tagIndex_.end()) {
+            it->remove(node);
+            if (it->isEmpty())
+                tagIndex_.erase(it);
+        }
+    }
+}
+
+void Model::emitActiveDataChanged(std::vector<std::shared_ptr<Node>> const &nodes) {
+    ZoneScoped;
+
+    // background and tooltip of a node depend on active state of its descendants, so ancestors need a refresh too
+    QHash<Node const *, std::pair<std::shared_ptr<Node>, std::vector<int>>> rowsByParent;
+    QSet<Node const *> seen;
+    for (auto const &changedNode: nodes) {
+        for (auto node = changedNode; node && node != root; node = node->parent()) {
+            if (seen.contains(&*node))
+                break;
+            seen.insert(&*node);
+
+            auto parent = node->parent();
+            auto &[parentNode, rows] = rowsByParent[&*parent];
+            parentNode = parent;
+            rows.push_back(toIndex(*node).row());
+        }
+    }
+
+    for (auto &[parentNode, rows]: rowsByParent) {
+        auto parent = toIndex(*parentNode);
+        auto lastColumn = columnCount(parent) - 1;
+
+        std::ranges::sort(rows);
+        for (std::size_t first = 0; first != rows.size();) {
+            auto end = first + 1;
+            while (end != rows.size() && rows[end] == rows[end - 1] + 1)
+                ++end;
+            emit dataChanged(index(rows[first], 0, parent), index(rows[end - 1], lastColumn, parent));
+            first = end;
+        }
+    }
+}
 }
@@ -17,8 +17,11 @@
 #pragma once
 #include "Node.hpp"
 
+#include "../TagDictionary.hpp"
+
 namespace TagLibrary {
 class NodeRoot;
+class NodeSerializable;
 
 static constexpr QStringView mimeType = u"application/x.simpletagger.taglibrary.nodes";
 enum class NodesMimeKey {
@@ -80,7 +83,15 @@ public:
 
     [[nodiscard]] std::expected<void, QString> resetRoot();
     [[nodiscard]] std::expected<QCborValue, QString> save() const;
+    // Shallow saves (see NodeSerializable::SaveMode::Shallow) of the nodes whose persisted data or list of children
+    // changed since the last load, save() or clearChangedNodes(). Removed nodes are not reported, they're simply no
+    // longer referenced by their former parent.
+    [[nodiscard]] std::expected<QCborArray, QString> saveChangedNodes() const;
+    void clearChangedNodes();
+    [[nodiscard]] QUuid rootUuid() const;
     [[nodiscard]] std::expected<void, QString> load(QCborValue const &value);
+    // Builds the nodes directly while parsing; the reader should be positioned at the root node.
+    [[nodiscard]] std::expected<void, QString> load(QCborStreamReader &reader);
 
     void setEditMode(bool editMode);
     [[nodiscard]] bool editMode() const;
@@ -94,7 +105,12 @@ public:
     void setNextLibraryVersion(int nextVersion);
 
     [[nodiscard]] std::expected<void, Error> invalidateTagCaches() const;
+    // Drops tag caches of everything that might resolve its tags differently after the tags of the node changed: its
+    // subtree and, transitively, the shadows and links mirroring any of these nodes.
+    void invalidateTagCaches(Node &node) const;
 
+    // Distinct resolved tags of all nodes, in the order they first appeared: visit order for the initial scan, after
+    // which newly appearing tags are appended.
     QStringList allTags() const;
 
 signals:
@@ -103,9 +119,27 @@ signals:
     void persistentDataChanged();
 
 private:
+    template<typename Loader>
+    [[nodiscard]] std::expected<void, QString> replaceRoot(Loader const &loader);
+
     void nodeUUIDRegister(std::shared_ptr<Node> const &node);
     void nodeUUIDChanged(std::shared_ptr<Node> const &node, QUuid const &oldUuid, bool replaceExisting);
     void nodeUUIDUnregister(std::shared_ptr<Node> const &node);
+    void nodeActiveChanged(std::shared_ptr<Node> const &node, bool active);
+    void nodeTagsDependOn(std::shared_ptr<Node> const &node, Node const *dependency);
+    void nodeTagsAdded(std::shared_ptr<Node> const &node);
+    void nodeTagsRemoved(std::shared_ptr<Node> const &node);
+    void nodePersistentDataChanged(std::shared_ptr<Node> const &node);
+    void nodeChildrenChanged(std::shared_ptr<Node> const &node);
+
+    // all below require allTagsMutex_ to be locked
+    void markTagsDirty_(std::shared_ptr<Node> const &node) const;
+    [[nodiscard]] std::expected<void, Error> updateTagAggregates_() const;
+    void addNodeTags_(std::shared_ptr<Node> const &node) const;
+    void removeNodeTags_(Node const *node) const;
+    void compactTagOrder_() const;
+
+    void emitActiveDataChanged(std::vector<std::shared_ptr<Node>> const &nodes);
 
     // Uuid of the specific model instance. Randomly generated on every instantiation (startup etc).
     // It's used to distinguish in copy or drag&drop operations between nodes coming from the same model
@@ -119,9 +153,29 @@ private:
     std::optional<int> highlightChangedAfterVersion_;
 
     QHash<QUuid, std::weak_ptr<Node>> uuidToNode_;
+    // see saveChangedNodes()
+    QHash<Node const *, std::weak_ptr<NodeSerializable>> changedNodes_;
     QSet<QUuid> uuidToNodeReplaced_;
 
+    // node -> nodes whose tags are derived from its tags (shadows of it, links to it), and the reverse
+    QHash<Node const *, QHash<Node const *, std::weak_ptr<Node>>> tagDependents_;
+    QHash<Node const *, Node const *> tagDependencies_;
+
+    // Resolved tags of every node, aggregated into tag counts and an inverted index. Maintained incrementally: nodes
+    // whose tags might have changed are queued in dirtyTagNodes_ and re-read on the next allTags() or
+    // setTagsActive(). Nothing is tracked until the first full scan.
     mutable QMutex allTagsMutex_;
+    mutable bool tagsScanned_ = false;
+    mutable QHash<Node const *, std::weak_ptr<Node>> dirtyTagNodes_;
+    mutable QHash<Node const *, TagIdList> nodeTags_;
+    mutable QHash<TagId, int> tagCounts_;
+    // tags in the order of allTags(); may hold tags whose count dropped to zero, or repeat ones that reappeared, until
+    // compacted by allTags()
+    mutable TagIdList tagOrder_;
     mutable std::optional<QStringList> allTags_;
+    // resolved tag -> nodes that can be set active and have that tag
+    mutable QHash<TagId, QHash<Node const *, std::weak_ptr<Node>>> tagIndex_;
+    // nodes currently active, so that setTagsActive() only has to look at these to find the ones to deactivate
+    QHash<Node const *, std::weak_ptr<Node>> activeNodes_;
 };
 }
@@ -29,13 +29,17 @@ Node::Node(Model &model): model_(model) {
     ZoneScoped;
     connect(this, &Node::dataChanged, this, [this]{
         ZoneScoped;
+        // active and highlighted state, as well as last change version of shadows, are only reported this way
+        invalidateSubtreeAggregates();
         auto [index1, index2] = model_.toIndexRange(*this);
         emit model_.dataChanged(index1, index2);
     });
     connect(this, &Node::persistentDataChanged, this, [this]{
         ZoneScoped;
-        emit dataChanged();
+        // before dataChanged(), so that whatever reacts to it sees the new version
         setLastChangeVersion(model_.nextLibraryVersion_);
+        emit dataChanged();
+        model_.nodePersistentDataChanged(shared_from_this());
         emit model_.persistentDataChanged();
     });
     connect(this, &Node::activeChanged, this, [this](bool const active){
@@ -49,6 +53,7 @@ Node::Node(Model &model): model_(model) {
     connect(this, &Node::insertChildrenEnd, this, [this]{
         ZoneScoped;
         emit model_.endInsertRows();
+        model_.nodeChildrenChanged(shared_from_this());
         emit model_.persistentDataChanged();
     });
     connect(this, &Node::removeChildrenBegin, this, [this](int const first, int const last){
@@ -58,6 +63,7 @@ Node::Node(Model &model): model_(model) {
     connect(this, &Node::removeChildrenEnd, this, [this]{
         ZoneScoped;
         emit model_.endRemoveRows();
+        model_.nodeChildrenChanged(shared_from_this());
         emit model_.persistentDataChanged();
     });
 }
@@ -71,6 +77,8 @@ std::expected<void, QString> Node::init() {
     assert(!initialized_);
     assert(!deinitialized_);
     model().nodeUUIDRegister(shared_from_this());
+    model().nodeTagsAdded(shared_from_this());
+    model().nodePersistentDataChanged(shared_from_this());
     initialized_ = true;
     return {};
 }
@@ -81,6 +89,8 @@ void Node::deinit() {
     assert(!deinitialized_);
     emit aboutToRemove();
     model().nodeUUIDUnregister(shared_from_this());
+    model().nodeActiveChanged(shared_from_this(), false);
+    model().nodeTagsRemoved(shared_from_this());
     deinitialized_ = true;
 }
 
@@ -182,6 +192,10 @@ std::vector<Node::Tag> Node::generateTags(TagLibrary::Node::TagFlags const) cons
 
 void Node::invalidateTagCache() const {
     tagCache_.clear();
+
+    // tags of active nodes are listed in tooltips of their ancestors
+    if (auto a = active(); a && *a)
+        invalidateSubtreeAggregates();
 }
 
 bool Node::canSetTags() const {
@@ -291,16 +305,9 @@ std::expected<bool, Error> Node::lastChangeAfter(int const version, bool const a
         else if (*result)
             return true;
 
-        // nope, we were not changed, but perhaps out child was? Go check
-        if (auto result = find(VisitFlag::Recursive | VisitFlag::ExcludeSelf, [&](auto &&node)->std::expected<bool, Error>{
-            if (auto result = node->lastChangeAfter(version, true, false); !result)
-                return result;
-            else
-                return *result;
-        }); !result)
-            return std::unexpected(result.error());
-        else
-            return static_cast<bool>(result);
+        // nope, we were not changed, but perhaps out child was? The subtree knows
+        auto maxVersion = subtreeAggregates().maxLastChangeVersion;
+        return maxVersion && *maxVersion > version;
     }
 }
 
@@ -319,27 +326,9 @@ std::vector<QBrush> Node::background(bool const editMode) const {
         if (auto h = this->highlighted(); h && *h)
             highlighted = true;
 
-        bool anyDescendantActive = false;
-        bool anyDescendantHighlighted = false;
-
-        if (auto result = visit(VisitFlag::Recursive, [&](auto const &node)->std::expected<bool, Error>{
-            if (!anyDescendantActive) {
-                if (auto active = node->active(); active && *active)
-                    anyDescendantActive = true;
-            }
-
-            if (!anyDescendantHighlighted) {
-                if (auto highlighted = node->highlighted(); highlighted && *highlighted)
-                    anyDescendantHighlighted = true;
-            }
-
-            // if we already know we've got an active descendant and a highlighted descendant,
-            // then we don't have to look for anything more
-            return !anyDescendantActive || !anyDescendantHighlighted;
-        }); !result) {
-            reportError("Node::background visit", result.error());
-            return {};
-        }
+        auto const &aggregates = subtreeAggregates();
+        bool anyDescendantActive = aggregates.activeCount != 0;
+        bool anyDescendantHighlighted = aggregates.highlightedCount != 0;
 
         static constexpr QColor activeColor = QColor(0, 255, 0, 128);
 
@@ -364,38 +353,64 @@ std::vector<QBrush> Node::background(bool const editMode) const {
 std::expected<QString, QString> Node::tooltip(bool const editMode) const {
     ZoneScoped;
 
-    if (!editMode) {
-        QString tooltip;
-
-        if (auto comment = this->comment(); !comment.isEmpty())
-            tooltip += QString("%1").arg(comment);
-
-        QStringList activeTagsLines;
-        if (auto result = visit(VisitFlag::Recursive, [&](auto &&node)->std::expected<bool, Error>{
-                if (auto active = node->active(); active && *active)
-                    activeTagsLines.emplace_back(node->tags()
-                            | std::views::transform([](auto const &tag){ return tag.resolved; })
-                            | std::views::join_with(QString(", "))
-                            | std::ranges::to<QString>());
-                return true;
-        }); !result) {
-            return std::unexpected(result.error());
-        } else {
-            auto activeTags = activeTagsLines
-                    | std::views::join_with(QString("<br>"))
-                    | std::ranges::to<QString>();
-
-            if (!activeTags.isEmpty()) {
-                if (!tooltip.isEmpty())
-                    tooltip += "<br><br>";
-                tooltip += QString("Active tags:<br>%1").arg(activeTags);
-            }
+    if (editMode)
+        return {};
+
+    // computes the aggregates, so that the cache is set only while they're valid
+    auto const activeCount = subtreeAggregates().activeCount;
+
+    if (tooltipCache_)
+        return *tooltipCache_;
+
+    QString tooltip;
+
+    if (auto comment = this->comment(); !comment.isEmpty())
+        tooltip += QString("%1").arg(comment);
+
+    // same order as visit(), but only descending into subtrees that have anything active
+    QStringList activeTagsLines;
+    auto collect = [&](this auto const &self, Node const &node) -> std::expected<void, QString> {
+        if (node.subtreeAggregates().activeCount == 0)
+            return {};
+
+        if (auto active = node.active(); active && *active)
+            activeTagsLines.emplace_back(node.tags()
+                    | std::views::transform([](auto const &tag){ return tag.resolved; })
+                    | std::views::join_with(QString(", "))
+                    | std::ranges::to<QString>());
+
+        auto count = node.childrenCount(false);
+        if (!count)
+            return std::unexpected(count.error());
+
+        for (int i = 0; i != *count; ++i) {
+            auto child = node.childOfRow(i, false);
+            if (!child)
+                return std::unexpected(child.error());
+            if (auto result = self(**child); !result)
+                return result;
         }
 
-        return tooltip;
-    } else {
         return {};
+    };
+
+    if (activeCount != 0) {
+        if (auto result = collect(*this); !result)
+            return std::unexpected(result.error());
+
+        auto activeTags = activeTagsLines
+                | std::views::join_with(QString("<br>"))
+                | std::ranges::to<QString>();
+
+        if (!activeTags.isEmpty()) {
+            if (!tooltip.isEmpty())
+                tooltip += "<br><br>";
+            tooltip += QString("Active tags:<br>%1").arg(activeTags);
+        }
     }
+
+    tooltipCache_ = tooltip;
+    return tooltip;
 }
 
 QString Node::path(PathFlags flags) const {
@@ -434,6 +449,215 @@ void Node::uuidChanged(QUuid const &oldUuid, bool const replaceExisting) {
     model().nodeUUIDChanged(shared_from_this(), oldUuid, replaceExisting);
 }
 
+void Node::activeStateChanged(bool const active) {
+    invalidateSubtreeAggregates();
+    model().nodeActiveChanged(shared_from_this(), active);
+}
+
+void Node::dependTagsOn(Node const *const node) {
+    model().nodeTagsDependOn(shared_from_this(), node);
+}
+
+Node::SubtreeAggregates const &Node::subtreeAggregates() const {
+    ZoneScoped;
+
+    if (subtreeAggregates_)
+        return *subtreeAggregates_;
+
+    SubtreeAggregates aggregates;
+    aggregates.maxLastChangeVersion = lastChangeVersion();
+    if (auto a = active(); a && *a)
+        ++aggregates.activeCount;
+    if (auto h = highlighted(); h && *h)
+        ++aggregates.highlightedCount;
+
+    if (auto count = childrenCount(false); !count) {
+        reportError("Node::subtreeAggregates childrenCount", count.error());
+    } else {
+        for (int i = 0; i != *count; ++i) {
+            auto child = childOfRow(i, false);
+            if (!child) {
+                reportError("Node::subtreeAggregates childOfRow", child.error());
+                continue;
+            }
+
+            auto const &childAggregates = (*child)->subtreeAggregates();
+            if (childAggregates.maxLastChangeVersion)
+                aggregates.maxLastChangeVersion = std::max(
+                        aggregates.maxLastChangeVersion.value_or(*childAggregates.maxLastChangeVersion),
+                        *childAggregates.maxLastChangeVersion
+                );
+            aggregates.descendantsCount += 1 + childAggregates.descendantsCount;
+            aggregates.activeCount += childAggregates.activeCount;
+            aggregates.highlightedCount += childAggregates.highlightedCount;
+        }
+    }
+
+    subtreeAggregates_ = aggregates;
+    return *subtreeAggregates_;
+}
+
+void Node::invalidateSubtreeAggregates() const {
+    subtreeAggregates_.reset();
+    tooltipCache_.reset();
+
+    // an invalid node has invalid ancestors (computing theirs would have computed its), so the walk can stop there;
+    // not at the node itself, which may be a shadow root, never visited on its own
+    for (auto parent = unreplacedParent(); parent && parent->subtreeAggregates_; parent = parent->unreplacedParent()) {
+        parent->subtreeAggregates_.reset();
+        parent->tooltipCache_.reset();
+    }
+}
+
+std::shared_ptr<Node> Node::unreplacedParent() const {
+    return parent();
+}
+
+std::optional<int> Node::cachedRowOfChild(Node const &node, bool const replaceReplaced) const {
+    ZoneScoped;
+
+    auto &table = rowTables_[replaceReplaced];
+
+    if (!table) {
+        // same enumeration as childOfRow(); a node listed more than once keeps its first row, just like with a search
+        auto build = [&]() -> std::optional<RowTable> {
+            auto count = childrenCount(false);
+            if (!count)
+                return std::nullopt;
+
+            RowTable result;
+            result.rows.reserve(*count);
+
+            int row = 0;
+            for (int i = 0; i != *count; ++i) {
+                auto child = childOfRow(i, false);
+                if (!child)
+                    return std::nullopt;
+
+                // a replaced node gets the row where its first replacement is displayed
+                if (!result.rows.contains(&**child))
+                    result.rows.insert(&**child, row);
+
+                if (!replaceReplaced || !(*child)->isReplaced()) {
+                    ++row;
+                    continue;
+                }
+
+                result.hasReplaced = true;
+
+                auto replacedCount = (*child)->childrenCount(true);
+                if (!replacedCount)
+                    return std::nullopt;
+
+                for (int replacedRow = 0; replacedRow != *replacedCount; ++replacedRow, ++row) {
+                    auto replacedChild = (*child)->childOfRow(replacedRow, true);
+                    if (!replacedChild)
+                        return std::nullopt;
+
+                    if (!result.rows.contains(&**replacedChild))
+                        result.rows.insert(&**replacedChild, row);
+                }
+            }
+            return result;
+        };
+
+        table = build();
+        if (!table)
+            return std::nullopt;
+    }
+
+    if (auto it = table->rows.find(&node); it != table->rows.end())
+        return *it;
+    else
+        return std::nullopt;
+}
+
+void Node::childrenInserted(int const first, int const last) const {
+    ZoneScoped;
+
+    std::vector<Node const *> inserted;
+    bool replacedInserted = false;
+    for (int row = first; row <= last; ++row) {
+        auto child = childOfRow(row, false);
+        if (!child) {
+            reportError("Node::childrenInserted childOfRow", child.error());
+            childrenChanged();
+            return;
+        }
+        inserted.push_back(&**child);
+        replacedInserted = replacedInserted || (*child)->isReplaced();
+    }
+
+    auto shift = [&](std::optional<RowTable> &table) {
+        if (!table)
+            return;
+
+        for (auto &row: table->rows)
+            if (row >= first)
+                row += gsl::narrow<int>(inserted.size());
+
+        // a node listed more than once keeps its first row
+        for (int i = 0; i != gsl::narrow<int>(inserted.size()); ++i)
+            if (auto it = table->rows.find(inserted[i]); it == table->rows.end())
+                table->rows.insert(inserted[i], first + i);
+            else
+                *it = std::min(*it, first + i);
+    };
+
+    shift(rowTables_[false]);
+    if (auto &table = rowTables_[true]; table && (table->hasReplaced || replacedInserted))
+        table.reset();
+    else
+        shift(table);
+
+    invalidateReplacingRowTable();
+    invalidateSubtreeAggregates();
+}
+
+void Node::childrenRemoved(int const first, int const last) const {
+    ZoneScoped;
+
+    auto shift = [&](std::optional<RowTable> &table) {
+        if (!table)
+            return;
+
+        // another occurrence of a removed node is found by the search rowOfChild() falls back to
+        for (auto it = table->rows.begin(); it != table->rows.end(); ) {
+            if (*it >= first && *it <= last) {
+                it = table->rows.erase(it);
+            } else {
+                if (*it > last)
+                    *it -= last - first + 1;
+                ++it;
+            }
+        }
+    };
+
+    shift(rowTables_[false]);
+    if (auto &table = rowTables_[true]; table && table->hasReplaced)
+        table.reset();
+    else
+        shift(table);
+
+    invalidateReplacingRowTable();
+    invalidateSubtreeAggregates();
+}
+
+void Node::childrenChanged() const {
+    for (auto &table: rowTables_)
+        table.reset();
+    invalidateReplacingRowTable();
+    invalidateSubtreeAggregates();
+}
+
+void Node::invalidateReplacingRowTable() const {
+    if (!isReplaced())
+        return;
+
+    if (auto parent = this->parent())
+        parent->rowTables_[true].reset();
+}
+
 std::expected<void, QStringList> Node::verify(VerifyContext &context) const {
     gsl_Expects(&model_);  // this is not an acceptable circumstance ever
     gsl_Expects(!deinitialized_);  // this one too
@@ -182,7 +182,7 @@ public:
 protected:
     [[nodiscard]] virtual std::vector<Tag> generateTags(TagFlags flags = TagFlag::IncludeResolved) const;
 public:
-    void invalidateTagCache() const;
+    virtual void invalidateTagCache() const;
     [[nodiscard]] virtual bool canSetTags() const;
     [[nodiscard]] virtual std::expected<void, QString> setTags(QStringList const &tags);
     [[nodiscard]] virtual QStringList resolveChildTag(QString const &tag) const;
@@ -216,8 +216,20 @@ public:
     virtual void setLastChangeVersion(int version);
     [[nodiscard]] std::expected<bool, Error> lastChangeAfter(int version, bool anyChild, bool anyParent) const;
 
+    // Summary of the subtree of the node (the node itself included) as enumerated by visit() without
+    // ReplaceReplaced. Kept up to date by dropping it from the node and its ancestors whenever anything it covers
+    // changes, and rebuilding from the summaries of the children on next use.
+    struct SubtreeAggregates {
+        std::optional<int> maxLastChangeVersion;
+        int descendantsCount = 0; // the node itself excluded
+        int activeCount = 0;
+        int highlightedCount = 0;
+    };
+    [[nodiscard]] SubtreeAggregates const &subtreeAggregates() const;
+
     [[nodiscard]] virtual std::vector<QBrush> background(bool editMode) const;
 
+    // built on first use and cached along with the subtree aggregates, as it lists tags of active descendants
     [[nodiscard]] std::expected<QString, QString> tooltip(bool editMode) const;
 
     enum class PathFlag {
@@ -251,8 +263,30 @@ public:
     };
     [[nodiscard]] virtual std::expected<void, QString> repopulateShadows(RepopulationRequest const &repopulationRequest) = 0;
 
+    // Only made public to be called by a shadow root on its owner, whose children it provides. For a replaced node,
+    // drops the table of the parent, which displays the children of the node in its place.
+    virtual void invalidateReplacingRowTable() const;
+
 protected:
     void uuidChanged(QUuid const &oldUuid, bool replaceExisting);
+    // to be called by setActive() implementations whenever the active state changes
+    void activeStateChanged(bool active);
+    // to be called by nodes whose tags are derived from tags of another node, so that their caches get invalidated
+    // along with it; nullptr removes the dependency
+    void dependTagsOn(Node const *node);
+    // Row of the child, looked up in a table built on first use. Meant for rowOfChild() implementations, which fall
+    // back to searching the children (and reporting an error) on nullopt.
+    [[nodiscard]] std::optional<int> cachedRowOfChild(Node const &node, bool replaceReplaced) const;
+    // To be called by subclasses right after children at [first, last] of childOfRow(_, false) have been inserted
+    // or removed, so that the row tables shift the rows after the edit point instead of getting rebuilt, and the
+    // subtree aggregates of the node and its ancestors get dropped.
+    void childrenInserted(int first, int last) const;
+    void childrenRemoved(int first, int last) const;
+    // for changes of children the above can't describe
+    void childrenChanged() const;
+    void invalidateSubtreeAggregates() const;
+    // parent as enumerated by visit() without ReplaceReplaced, whose subtree aggregates cover the node
+    [[nodiscard]] virtual std::shared_ptr<Node> unreplacedParent() const;
 
     struct VerifyContext {
         QSet<QUuid> uuids;
@@ -283,6 +317,19 @@ private:
     };
 
     mutable QHash<TagFlags, std::vector<Tag>> tagCache_;
+
+    struct RowTable {
+        QHash<Node const *, int> rows;
+        // rows of the replaced view only follow the children while there's nothing replaced among them
+        bool hasReplaced = false;
+    };
+    // indexed by replaceReplaced, nullopt until first use
+    mutable std::array<std::optional<RowTable>, 2> rowTables_;
+
+    // nullopt when invalidated
+    mutable std::optional<SubtreeAggregates> subtreeAggregates_;
+    // only set while subtreeAggregates_ is valid, and dropped along with it
+    mutable std::optional<QString> tooltipCache_;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Node::VisitFlags);
@@ -51,6 +51,9 @@ bool NodeHierarchical::canRemove() const {
 std::expected<int, QString> NodeHierarchical::rowOfChild(Node const &node, bool const replaceReplaced) const {
     ZoneScoped;
 
+    if (auto row = cachedRowOfChild(node, replaceReplaced))
+        return *row;
+
     if (!replaceReplaced) {
         auto it = std::ranges::find_if(
                 children_,
@@ -167,6 +170,7 @@ std::expected<std::shared_ptr<Node>, QString> NodeHierarchical::insertChild(int
 
     emit insertChildrenBegin(row, row);
     auto result = *children_.emplace(children_.begin() + row, std::move(ptr));
+    childrenInserted(row, row);
     emit insertChildrenEnd(row, row);
 
     return result;
@@ -193,6 +197,7 @@ void NodeHierarchical::removeChildren(int const row, int const count) {
 
     emit removeChildrenBegin(row, last);
     children_.erase(begin, end);
+    childrenRemoved(row, last);
     emit removeChildrenEnd(row, last);
 }
 
@@ -233,21 +238,7 @@ std::expected<void, QString> NodeHierarchical::repopulateShadows(RepopulationReq
     return {};
 }
 
-std::expected<void, QString> NodeHierarchical::saveNodeData(QCborMap &map) const {
-    ZoneScoped;
-
-    if (auto result = NodeSerializable::saveNodeData(map); !result)
-        return std::unexpected(result.error());
-
-    if (auto array = saveChildrenNodes(); !array)
-        return std::unexpected(array.error());
-    else if (*array)
-        map[std::to_underlying(Format::NodeKey::Children)] = **array;
-
-    return {};
-}
-
-std::expected<std::optional<QCborArray>, QString> NodeHierarchical::saveChildrenNodes() const {
+std::expected<void, QString> NodeHierarchical::saveChildrenNodes(QCborMap &map, SaveMode const mode) const {
     ZoneScoped;
 
     QCborArray children;
@@ -257,25 +248,16 @@ std::expected<std::optional<QCborArray>, QString> NodeHierarchical::saveChildren
         if (auto child = childOfRow(i, false); !child) {
             return std::unexpected(child.error());
         } else if (auto serializableChild = std::dynamic_pointer_cast<NodeSerializable>(*child)) {
-            if (auto childData = serializableChild->save())
+            if (mode == SaveMode::Shallow)
+                children.append(serializableChild->uuid().toRfc4122());
+            else if (auto childData = serializableChild->save())
                 children.append(*childData);
             else
                 return std::unexpected(childData.error());
         }
     }
 
-    return children;
-}
-
-std::expected<void, QString> NodeHierarchical::loadNodeData(QCborMap &map, bool const allowDuplicatedUuids) {
-    ZoneScoped;
-
-    if (auto result = NodeSerializable::loadNodeData(map, allowDuplicatedUuids); !result)
-        return std::unexpected(result.error());
-
-    if (auto result = loadChildrenNodes(map, allowDuplicatedUuids); !result)
-        return std::unexpected(result.error());
-
+    map[std::to_underlying(Format::NodeKey::Children)] = children;
     return {};
 }
 
@@ -290,6 +272,7 @@ std::expected<void, QString> NodeHierarchical::loadChildrenNodes(QCborMap &map,
 
     auto childrenArray = children.toArray();
     children_.clear();
+    childrenChanged();
     children_.reserve(childrenArray.size());
 
     for (auto const &child: childrenArray) {
@@ -303,4 +286,33 @@ std::expected<void, QString> NodeHierarchical::loadChildrenNodes(QCborMap &map,
 
     return {};
 }
+
+std::expected<void, QString> NodeHierarchical::readChildrenNodes(QCborStreamReader &reader, bool const allowDuplicatedUuids) {
+    ZoneScoped;
+
+    if (!reader.isArray())
+        return std::unexpected(QObject::tr("Node children is not an array"));
+
+    children_.clear();
+    childrenChanged();
+    if (reader.isLengthKnown())
+        children_.reserve(reader.length());
+
+    if (!reader.enterContainer())
+        return std::unexpected(reader.lastError().toString());
+
+    while (reader.hasNext()) {
+        if (auto childNode = NodeHierarchical::load(
+                reader, model(), std::dynamic_pointer_cast<NodeHierarchical>(shared_from_this()), allowDuplicatedUuids
+        ); !childNode)
+            return std::unexpected(childNode.error());
+        else
+            children_.emplace_back(std::move(*childNode));
+    }
+
+    if (!reader.leaveContainer())
+        return std::unexpected(reader.lastError().toString());
+
+    return {};
+}
 }
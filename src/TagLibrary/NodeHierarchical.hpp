@@ -57,10 +57,9 @@ public:
     [[nodiscard]] std::expected<void, QString> repopulateShadows(RepopulationRequest const &repopulationRequest = {}) override;
 
 protected:
-    [[nodiscard]] std::expected<void, QString> saveNodeData(QCborMap &map) const override;
-    [[nodiscard]] virtual std::expected<std::optional<QCborArray>, QString> saveChildrenNodes() const;
-    [[nodiscard]] std::expected<void, QString> loadNodeData(QCborMap &map, bool allowDuplicatedUuids) override;
-    [[nodiscard]] virtual std::expected<void, QString> loadChildrenNodes(QCborMap &map, bool allowDuplicatedUuids);
+    [[nodiscard]] std::expected<void, QString> saveChildrenNodes(QCborMap &map, SaveMode mode) const override;
+    [[nodiscard]] std::expected<void, QString> loadChildrenNodes(QCborMap &map, bool allowDuplicatedUuids) override;
+    [[nodiscard]] std::expected<void, QString> readChildrenNodes(QCborStreamReader &reader, bool allowDuplicatedUuids) override;
 
     friend class Model;
 
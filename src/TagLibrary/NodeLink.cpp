@@ -157,6 +157,14 @@ std::vector<Node::Tag> NodeLink::generateTags(TagFlags const flags) const {
     return result;
 }
 
+void NodeLink::invalidateTagCache() const {
+    Node::invalidateTagCache();
+
+    // the shadow root isn't reachable by visiting the tree, but it resolves its tags through us
+    if (shadowRoot_)
+        shadowRoot_->invalidateTagCache();
+}
+
 QStringList NodeLink::resolveChildTag(QString const &tag) const {
     ZoneScoped;
     return parent()->resolveChildTag(tag);
@@ -191,6 +199,7 @@ std::expected<void, QString> NodeLink::setActive(bool const active) {
     ZoneScoped;
     if (active != active_) {
         active_ = active;
+        activeStateChanged(active);
         emit activeChanged(active);
         emit dataChanged();
     }
@@ -245,8 +254,8 @@ std::expected<void, QString> NodeLink::saveNodeData(QCborMap &map) const {
     return {};
 }
 
-std::expected<std::optional<QCborArray>, QString> NodeLink::saveChildrenNodes() const {
-    return std::nullopt;
+std::expected<void, QString> NodeLink::saveChildrenNodes(QCborMap &, SaveMode const) const {
+    return {};
 }
 
 std::expected<void, QString> NodeLink::loadNodeData(QCborMap &map, bool const allowDuplicatedUuids) {
@@ -283,6 +292,11 @@ std::expected<void, QString> NodeLink::loadChildrenNodes([[maybe_unused]] QCborM
     return {};
 }
 
+std::expected<void, QString> NodeLink::readChildrenNodes(QCborStreamReader &, bool const) {
+    // children of a link are shadows of its target, they're never saved
+    return std::unexpected(QObject::tr("Link node cannot have children"));
+}
+
 IconIdentifier NodeLink::linkingIcon() const {
     return IconIdentifier(":/icons/bx-link.svg");
 }
@@ -342,6 +356,9 @@ std::expected<void, QString> NodeLink::populateShadowsImpl() {
             emitInsertChildrenBegin(*childrenCount);
 
         shadowRoot_ = std::move(subtreeRoot);
+        childrenChanged();
+        dependTagsOn(&**target);
+        model().invalidateTagCaches(*this);
 
         if (*childrenCount > 0)
             emitInsertChildrenEnd(*childrenCount);
@@ -366,6 +383,9 @@ std::expected<void, QString> NodeLink::unpopulateShadowsImpl() {
             shadowRoot_->deinit();
 
         shadowRoot_.reset();
+        childrenChanged();
+        dependTagsOn(nullptr);
+        model().invalidateTagCaches(*this);
 
         if (*childrenCount > 0)
             emitRemoveChildrenEnd(*childrenCount);
@@ -389,13 +409,15 @@ std::expected<void, QString> NodeLink::repopulateShadows(RepopulationRequest con
     }
 
     // target UUID and all its parents
+    std::shared_ptr<Node> target;
     if (!linkTo_.isNull()) {
-        if (auto target = model().fromUuid(linkTo_); !target) {
+        if (auto result = model().fromUuid(linkTo_); !result) {
             // TODO: this can be because target is invalid - but does not have to! There should be a way to
             //       distinguish such situations
-            qCWarning(LoggingCategory) << "Could not find node with UUID" << linkTo_ << ":" << target.error();
+            qCWarning(LoggingCategory) << "Could not find node with UUID" << linkTo_ << ":" << result.error();
         } else {
-            node = *target;
+            target = *result;
+            node = target;
             while(node) {
                 allRelatedUuids.insert(node->uuid());
                 node = node->parent();
@@ -406,11 +428,23 @@ std::expected<void, QString> NodeLink::repopulateShadows(RepopulationRequest con
     if (!repopulationRequest.modifiedUuids  // no specific UUIDs requested -> all are relevant
         || std::ranges::any_of(*repopulationRequest.modifiedUuids, [&](auto const &uuid){ return allRelatedUuids.contains(uuid); })
     ) {
-        if (auto result = unpopulateShadows(); !result)
-            return std::unexpected(result.error());
+        if (shadowRoot_ && target) {
+            // update in place, so that only the rows that actually differ get reported
+            bool retargeted = !shadowRoot_->isShadowOf(*target);
+            if (auto result = shadowRoot_->synchronize(target); !result)
+                return std::unexpected(result.error());
+
+            if (retargeted) {
+                dependTagsOn(&*target);
+                model().invalidateTagCaches(*this);
+            }
+        } else {
+            if (auto result = unpopulateShadows(); !result)
+                return std::unexpected(result.error());
 
-        if (auto result = populateShadows(); !result)
-            return std::unexpected(result.error());
+            if (auto result = populateShadows(); !result)
+                return std::unexpected(result.error());
+        }
     }
 
     if (shadowRoot_)
@@ -47,6 +47,7 @@ public:
     [[nodiscard]] std::expected<void, QString> setLinkTo(QUuid const &uuid) override;
 
     [[nodiscard]] std::vector<Tag> generateTags(TagFlags flags = TagFlag::IncludeResolved) const override;
+    void invalidateTagCache() const override;
     [[nodiscard]] QStringList resolveChildTag(QString const &tag) const override;
 
     [[nodiscard]] QString comment() const override;
@@ -67,9 +68,10 @@ public:
 
 protected:
     [[nodiscard]] std::expected<void, QString> saveNodeData(QCborMap &map) const override;
-    [[nodiscard]] std::expected<std::optional<QCborArray>, QString> saveChildrenNodes() const override;
+    [[nodiscard]] std::expected<void, QString> saveChildrenNodes(QCborMap &map, SaveMode mode) const override;
     [[nodiscard]] std::expected<void, QString> loadNodeData(QCborMap &map, bool allowDuplicatedUuids) override;
     [[nodiscard]] std::expected<void, QString> loadChildrenNodes(QCborMap &map, bool allowDuplicatedUuids) override;
+    [[nodiscard]] std::expected<void, QString> readChildrenNodes(QCborStreamReader &reader, bool allowDuplicatedUuids) override;
 
     [[nodiscard]] virtual IconIdentifier linkingIcon() const;
     virtual void emitInsertChildrenBegin(int count);
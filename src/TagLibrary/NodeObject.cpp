@@ -130,6 +130,7 @@ std::expected<void, QString> NodeObject::setTags(QStringList const &tags) {
             return std::unexpected("Cannot set empty tag");
 
         tags_ = tags;
+        model().invalidateTagCaches(*this);
         emit persistentDataChanged();
     }
     return {};
@@ -181,6 +182,7 @@ std::expected<void, QString> NodeObject::setActive(bool const active) {
     ZoneScoped;
     if (active != active_) {
         active_ = active;
+        activeStateChanged(active);
         emit activeChanged(active);
         emit dataChanged();
     }
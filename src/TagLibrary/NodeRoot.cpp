@@ -73,6 +73,7 @@ std::expected<std::shared_ptr<Node>, QString> NodeRoot::insertChild(int const ro
 
     emit insertChildrenBegin(row, row);
     rootCollection_ = std::move(ptr);
+    childrenInserted(row, row);
     emit insertChildrenEnd(row, row);
 
     gsl_Ensures(!node);
@@ -113,16 +114,15 @@ std::expected<void, QString> NodeRoot::repopulateShadows(RepopulationRequest con
         return {};
 }
 
-std::expected<void, QString> NodeRoot::saveNodeData(QCborMap &map) const {
+std::expected<void, QString> NodeRoot::saveChildrenNodes(QCborMap &map, SaveMode const mode) const {
     ZoneScoped;
 
-    if (auto result = NodeSerializable::saveNodeData(map); !result)
-        return std::unexpected(result.error());
-
     QCborArray children;
 
     if (rootCollection_) {
-        if (auto childData = rootCollection_->save())
+        if (mode == SaveMode::Shallow)
+            children.append(rootCollection_->uuid().toRfc4122());
+        else if (auto childData = rootCollection_->save())
             children.append(*childData);
         else
             return std::unexpected(childData.error());
@@ -132,12 +132,9 @@ std::expected<void, QString> NodeRoot::saveNodeData(QCborMap &map) const {
     return {};
 }
 
-std::expected<void, QString> NodeRoot::loadNodeData(QCborMap &map, bool const allowDuplicatedUuids) {
+std::expected<void, QString> NodeRoot::loadChildrenNodes(QCborMap &map, bool const allowDuplicatedUuids) {
     ZoneScoped;
 
-    if (auto result = NodeSerializable::loadNodeData(map, allowDuplicatedUuids); !result)
-        return std::unexpected(result.error());
-
     auto children = map.take(std::to_underlying(Format::NodeKey::Children));
     if (children.isUndefined())
         return std::unexpected(QObject::tr("Node has no children key"));
@@ -153,14 +150,43 @@ std::expected<void, QString> NodeRoot::loadNodeData(QCborMap &map, bool const al
                     child, model(), std::dynamic_pointer_cast<NodeRoot>(shared_from_this()), allowDuplicatedUuids
             ); !childNode)
                 return std::unexpected(childNode.error());
-            else
-                if (auto childCollection = std::dynamic_pointer_cast<NodeCollection>(std::move(*childNode)); !childCollection)
-                    return std::unexpected(QObject::tr("Root collection should be NodeCollection, not %1").arg(typeid(*childNode).name()));
-                else
-                    rootCollection_ = std::move(childCollection);
+            else if (auto result = setRootCollection(std::move(*childNode)); !result)
+                return result;
         }
     }
 
     return {};
 }
-}
\ No newline at end of file
+
+std::expected<void, QString> NodeRoot::readChildrenNodes(QCborStreamReader &reader, bool const allowDuplicatedUuids) {
+    ZoneScoped;
+
+    if (!reader.isArray())
+        return std::unexpected(QObject::tr("Node children is not an array"));
+    if (!reader.enterContainer())
+        return std::unexpected(reader.lastError().toString());
+
+    rootCollection_.reset();
+    while (reader.hasNext()) {
+        if (auto childNode = NodeHierarchical::load(
+                reader, model(), std::dynamic_pointer_cast<NodeRoot>(shared_from_this()), allowDuplicatedUuids
+        ); !childNode)
+            return std::unexpected(childNode.error());
+        else if (auto result = setRootCollection(std::move(*childNode)); !result)
+            return result;
+    }
+
+    if (!reader.leaveContainer())
+        return std::unexpected(reader.lastError().toString());
+
+    return {};
+}
+
+std::expected<void, QString> NodeRoot::setRootCollection(std::shared_ptr<NodeSerializable> &&node) {
+    if (auto childCollection = std::dynamic_pointer_cast<NodeCollection>(node); !childCollection)
+        return std::unexpected(QObject::tr("Root collection should be NodeCollection, not %1").arg(typeid(*node).name()));
+    else
+        rootCollection_ = std::move(childCollection);
+    return {};
+}
+}
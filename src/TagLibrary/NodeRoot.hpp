@@ -48,8 +48,12 @@ public:
     [[nodiscard]] std::expected<void, QString> repopulateShadows(RepopulationRequest const &repopulationRequest = {}) override;
 
 protected:
-    [[nodiscard]] std::expected<void, QString> saveNodeData(QCborMap &map) const override;
-    [[nodiscard]] std::expected<void, QString> loadNodeData(QCborMap &map, bool allowDuplicatedUuids) override;
+    [[nodiscard]] std::expected<void, QString> saveChildrenNodes(QCborMap &map, SaveMode mode) const override;
+    [[nodiscard]] std::expected<void, QString> loadChildrenNodes(QCborMap &map, bool allowDuplicatedUuids) override;
+    [[nodiscard]] std::expected<void, QString> readChildrenNodes(QCborStreamReader &reader, bool allowDuplicatedUuids) override;
+
+private:
+    [[nodiscard]] std::expected<void, QString> setRootCollection(std::shared_ptr<NodeSerializable> &&node);
 
 private:
     std::shared_ptr<NodeCollection> rootCollection_;
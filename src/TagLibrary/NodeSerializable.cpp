@@ -129,7 +129,7 @@ std::expected<void, QString> NodeSerializable::setHidden(bool const hidden) {
     return {};
 }
 
-std::expected<QCborValue, QString> NodeSerializable::save() const {
+std::expected<QCborValue, QString> NodeSerializable::save(SaveMode const mode) const {
     ZoneScoped;
 
     QCborMap map;
@@ -137,6 +137,9 @@ std::expected<QCborValue, QString> NodeSerializable::save() const {
     if (auto result = saveNodeData(map); !result)
         return std::unexpected(result.error());
 
+    if (auto result = saveChildrenNodes(map, mode); !result)
+        return std::unexpected(result.error());
+
     return map;
 }
 
@@ -179,6 +182,83 @@ std::expected<std::shared_ptr<NodeSerializable>, QString> NodeSerializable::load
         return std::unexpected(result.error());
     }
 
+    if (auto result = node->loadChildrenNodes(map, allowDuplicatedUuids); !result) {
+        node->deinit();
+        return std::unexpected(result.error());
+    }
+
+    for (auto const &v: map)
+        qCWarning(LoggingCategory) << "Unhandled element:" << v.first << "=" << v.second;
+
+    return node;
+}
+
+std::expected<std::shared_ptr<NodeSerializable>, QString> NodeSerializable::load(
+        QCborStreamReader &reader, Model &model,
+        std::shared_ptr<NodeSerializable> const &parent, bool const allowDuplicatedUuids
+) {
+    ZoneScoped;
+
+    if (!reader.isMap())
+        return std::unexpected(QObject::tr("Node is not a map"));
+    if (!reader.enterContainer())
+        return std::unexpected(reader.lastError().toString());
+
+    // Own fields of the node are small, so they're collected into a map for loadNodeData(). Children, which make up
+    // nearly all of the data, are constructed right away - as long as the type (needed to create the node) comes
+    // before them, which is the case for everything we save.
+    QCborMap map;
+    std::shared_ptr<NodeSerializable> node;
+    bool childrenLoaded = false;
+
+    auto fail = [&](QString const &error) {
+        // TODO: this should be solved via RAII
+        if (node)
+            node->deinit();
+        return std::unexpected(error);
+    };
+
+    while (reader.hasNext()) {
+        if (!reader.isInteger())
+            return fail(QObject::tr("Node key is not an integer"));
+        auto key = reader.toInteger();
+        reader.next();
+
+        if (key == std::to_underlying(Format::NodeKey::Type) && !node) {
+            auto typeValue = QCborValue::fromCbor(reader);
+            if (!typeValue.isInteger())
+                return fail(QObject::tr("Node type is not an integer but %1").arg(cborTypeToString(typeValue.type())));
+
+            if (auto result = createNode(static_cast<Format::NodeType>(typeValue.toInteger()), model, parent); !result)
+                return fail(result.error());
+            else
+                node = std::move(*result);
+        } else if (key == std::to_underlying(Format::NodeKey::Children) && node && !childrenLoaded) {
+            if (auto result = node->readChildrenNodes(reader, allowDuplicatedUuids); !result)
+                return fail(result.error());
+            childrenLoaded = true;
+        } else {
+            map.insert(key, QCborValue::fromCbor(reader));
+        }
+
+        if (reader.lastError() != QCborError::NoError)
+            return fail(reader.lastError().toString());
+    }
+
+    if (!reader.leaveContainer())
+        return fail(reader.lastError().toString());
+
+    if (!node)
+        return std::unexpected(QObject::tr("Node has no type key"));
+
+    if (auto result = node->loadNodeData(map, allowDuplicatedUuids); !result)
+        return fail(result.error());
+
+    if (!childrenLoaded) {
+        if (auto result = node->loadChildrenNodes(map, allowDuplicatedUuids); !result)
+            return fail(result.error());
+    }
+
     for (auto const &v: map)
         qCWarning(LoggingCategory) << "Unhandled element:" << v.first << "=" << v.second;
 
@@ -224,4 +304,18 @@ std::expected<void, QString> NodeSerializable::loadNodeData(QCborMap &map, bool
 
     return {};
 }
+
+std::expected<void, QString> NodeSerializable::saveChildrenNodes(QCborMap &, SaveMode const) const {
+    return {};
+}
+
+std::expected<void, QString> NodeSerializable::loadChildrenNodes(QCborMap &, bool const) {
+    return {};
+}
+
+std::expected<void, QString> NodeSerializable::readChildrenNodes(QCborStreamReader &, bool const) {
+    return std::unexpected(QObject::tr("Node of type %1 cannot have children").arg(
+            QMetaEnum::fromType<NodeType>().valueToKey(std::to_underlying(type()))
+    ));
+}
 }
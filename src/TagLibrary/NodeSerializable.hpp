@@ -43,13 +43,26 @@ public:
     void setLastChangeVersion(int version) override;
 
     // persistence
-    [[nodiscard]] std::expected<QCborValue, QString> save() const;
+    enum class SaveMode {
+        Recursive, // children are saved in full
+        Shallow    // children are referenced by their UUIDs only
+    };
+    [[nodiscard]] std::expected<QCborValue, QString> save(SaveMode mode = SaveMode::Recursive) const;
     [[nodiscard]] static std::expected<std::shared_ptr<NodeSerializable>, QString>
     load(QCborValue const &value, Model &model, std::shared_ptr<NodeSerializable> const &parent, bool allowDuplicatedUuids = false);
+    // Same as above, but constructs the nodes while parsing, without building the whole CBOR tree first. The reader is
+    // expected to be positioned at the node map and is left past it.
+    [[nodiscard]] static std::expected<std::shared_ptr<NodeSerializable>, QString>
+    load(QCborStreamReader &reader, Model &model, std::shared_ptr<NodeSerializable> const &parent, bool allowDuplicatedUuids = false);
 
 protected:
     [[nodiscard]] virtual std::expected<void, QString> saveNodeData(QCborMap &map) const;
+    [[nodiscard]] virtual std::expected<void, QString> saveChildrenNodes(QCborMap &map, SaveMode mode) const;
     [[nodiscard]] virtual std::expected<void, QString> loadNodeData(QCborMap &map, bool allowDuplicatedUuids);
+    // children are loaded separately from the rest of the node data, so that the streaming loader can construct them
+    // as soon as they're parsed
+    [[nodiscard]] virtual std::expected<void, QString> loadChildrenNodes(QCborMap &map, bool allowDuplicatedUuids);
+    [[nodiscard]] virtual std::expected<void, QString> readChildrenNodes(QCborStreamReader &reader, bool allowDuplicatedUuids);
 
 private:
     QUuid uuid_ = QUuid::createUuid();
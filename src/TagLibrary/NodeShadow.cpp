@@ -41,66 +41,11 @@ std::expected<void, QString> NodeShadow::init() {
     auto target = target_.lock();
     assert(target);
 
-    connect(&*target, &Node::dataChanged, this, [this]{
-        ZoneScoped;
-        icons_.reset();
-        if (auto owner = owner_.lock())
-            emit owner->dataChanged();
-        else
-            emit dataChanged();
-    });
-
-    connect(&*target, &Node::aboutToRemove, this, [this]{
-        ZoneScoped;
-        // NOTE: in contrast to other signals, which forward do subtreeRootOwner (if set), this signal does not.
-        //       the reason is, in contrast to other operations, removal of the link's target shouldn't lead to
-        //       the removal of the link itself
-        emit targetAboutToRemove();
-    });
-
-    connect(&*target, &Node::insertChildrenEnd, this, [this](int const first, int const last){
-        ZoneScoped;
-
-        // we can only do our insertions after the target has completed its
-        if (auto owner = owner_.lock())
-            emit owner->insertChildrenBegin(first, last);
-        else
-            emit insertChildrenBegin(first, last);
-        // TODO[C++23]
-        /*auto &&rg = std::views::repeat(nullptr)
-                | std::views::take(last - first + 1);
-        children_.insert_range(children_.begin() + first, rg);*/
-        for (int row = first; row <= last; ++row) {
-            if (auto child = createChild(row); !child)
-                qCCritical(LoggingCategory) << "Could not create a children in a linking subtree; subtree will get rendered inconsitently:" << child.error();
-            else
-                children_.emplace(children_.begin() + row, std::move(*child));
-        }
-
-        if (auto owner = owner_.lock())
-            emit owner->insertChildrenEnd(first, last);
-        else
-            emit insertChildrenEnd(first, last);
-    });
+    // the root's tags are mirrored by its owner, which registers the dependency itself
+    if (!isShadowRoot())
+        dependTagsOn(&*target);
 
-    connect(&*target, &Node::beforeRemoveChildren, this, [this](int const first, int const last) {
-        ZoneScoped;
-
-        // we must do our removals before the target has completed its
-        if (auto owner = owner_.lock())
-            emit owner->removeChildrenBegin(first, last);
-        else
-            emit removeChildrenBegin(first, last);
-
-        for (auto i = first; i <= last; ++i)
-            children_[i]->deinit();
-        children_.erase(children_.begin() + first, children_.begin() + last + 1);
-
-        if (auto owner = owner_.lock())
-            emit owner->removeChildrenEnd(first, last);
-        else
-            emit removeChildrenEnd(first, last);
-    });
+    connectTarget(*target);
 
     auto count = target->childrenCount(!model().editMode());
     if (!count)
@@ -144,9 +89,24 @@ std::shared_ptr<Node> NodeShadow::parent() const {
     return parent;
 }
 
+std::shared_ptr<Node> NodeShadow::unreplacedParent() const {
+    auto parent = parent_.lock();
+    assert(parent);
+
+    // the shadow root isn't visited, its owner is in its place
+    if (auto shadowParent = std::dynamic_pointer_cast<NodeShadow const>(parent))
+        if (auto owner = shadowParent->owner_.lock())
+            return owner;
+
+    return parent;
+}
+
 std::expected<int, QString> NodeShadow::rowOfChild(Node const &node, bool const replaceReplaced) const {
     ZoneScoped;
 
+    if (auto row = cachedRowOfChild(node, replaceReplaced))
+        return *row;
+
     // TODO: this is basically the same as in NodeHierarchical::rowOfChild, merge?
     if (!replaceReplaced) {
         auto it = std::ranges::find_if(
@@ -327,6 +287,7 @@ std::expected<void, QString> NodeShadow::setActive(bool const active) {
     ZoneScoped;
 
     active_ = active;
+    activeStateChanged(active);
 
     if (auto owner = owner_.lock()) {
         emit owner->activeChanged(active);
@@ -416,6 +377,237 @@ std::expected<void, QString> NodeShadow::repopulateShadows(RepopulationRequest c
     return {};
 }
 
+std::expected<void, QString> NodeShadow::synchronize(std::shared_ptr<Node> const &target) {
+    ZoneScoped;
+    gsl_Expects(target);
+
+    if (target != target_.lock()) {
+        // the target got recreated, e.g. moved by drag and drop; it has the same UUID, so the shadow stays valid
+        if (auto oldTarget = target_.lock())
+            disconnect(&*oldTarget, nullptr, this, nullptr);
+
+        target_ = target;
+        targetUuid_ = target->uuid();
+        connectTarget(*target);
+        icons_.reset();
+        if (!isShadowRoot()) {
+            dependTagsOn(&*target);
+            model().invalidateTagCaches(*this);
+        }
+
+        if (auto owner = owner_.lock())
+            emit owner->dataChanged();
+        else
+            emit dataChanged();
+    }
+
+    auto count = target->childrenCount(!model().editMode());
+    if (!count)
+        return std::unexpected(count.error());
+
+    std::vector<std::shared_ptr<Node>> targetChildren;
+    targetChildren.reserve(*count);
+    for (int row = 0; row != *count; ++row) {
+        if (auto child = target->childOfRow(row, !model().editMode()); !child)
+            return std::unexpected(child.error());
+        else
+            targetChildren.emplace_back(std::move(*child));
+    }
+
+    // match current children to the target's ones by UUID, which, unlike the pointers, survives nodes being recreated
+    QHash<QUuid, QList<int>> currentRowsByUuid;
+    for (int row = 0; row != gsl::narrow<int>(children_.size()); ++row)
+        currentRowsByUuid[children_[row]->uuid()].push_back(row);
+
+    std::vector<int> matchedRows(targetChildren.size(), -1);
+    for (std::size_t i = 0; i != targetChildren.size(); ++i) {
+        if (auto it = currentRowsByUuid.find(targetChildren[i]->uuid()); it != currentRowsByUuid.end() && !it->empty()) {
+            matchedRows[i] = it->takeFirst();
+        }
+    }
+
+    // only children forming the longest run in unchanged order can be kept, the others are recreated at new rows
+    std::vector<int> keptRows;
+    {
+        // patience sorting; tails[k] is the index (into matchedRows) ending the best increasing run of length k+1
+        std::vector<int> tails;
+        std::vector<int> previous(matchedRows.size(), -1);
+        for (int i = 0; i != gsl::narrow<int>(matchedRows.size()); ++i) {
+            if (matchedRows[i] == -1)
+                continue;
+
+            auto it = std::ranges::lower_bound(tails, matchedRows[i], {}, [&](int const index){ return matchedRows[index]; });
+            if (it != tails.begin())
+                previous[i] = *std::prev(it);
+            if (it == tails.end())
+                tails.push_back(i);
+            else
+                *it = i;
+        }
+
+        for (int i = tails.empty() ? -1 : tails.back(); i != -1; i = previous[i])
+            keptRows.push_back(i);
+        std::ranges::reverse(keptRows);
+    }
+
+    std::vector<bool> keepCurrent(children_.size(), false);
+    std::vector<bool> keepTarget(targetChildren.size(), false);
+    for (auto const i: keptRows) {
+        keepCurrent[matchedRows[i]] = true;
+        keepTarget[i] = true;
+    }
+
+    // remove contiguous ranges of stale children, from the last one so that rows of the remaining ones stay valid
+    for (int last = gsl::narrow<int>(children_.size()) - 1; last >= 0; --last) {
+        if (keepCurrent[last])
+            continue;
+
+        int first = last;
+        while (first > 0 && !keepCurrent[first - 1])
+            --first;
+
+        emitRemoveChildrenBegin(first, last);
+        for (auto i = first; i <= last; ++i)
+            children_[i]->deinit();
+        children_.erase(children_.begin() + first, children_.begin() + last + 1);
+        childrenRemoved(first, last);
+        emitRemoveChildrenEnd(first, last);
+
+        last = first;
+    }
+
+    // children kept are in the target's order now, so inserting missing ones in ascending order puts everything at
+    // the final rows
+    for (int first = 0; first != gsl::narrow<int>(targetChildren.size()); ++first) {
+        if (keepTarget[first])
+            continue;
+
+        int last = first;
+        while (last + 1 != gsl::narrow<int>(targetChildren.size()) && !keepTarget[last + 1])
+            ++last;
+
+        emitInsertChildrenBegin(first, last);
+        bool complete = true;
+        for (int row = first; row <= last; ++row) {
+            if (auto child = createChild(row); !child) {
+                qCCritical(LoggingCategory) << "Could not create a children in a linking subtree; subtree will get rendered inconsitently:" << child.error();
+                complete = false;
+            } else {
+                children_.emplace(children_.begin() + row, std::move(*child));
+            }
+        }
+        if (complete)
+            childrenInserted(first, last);
+        else
+            childrenChanged();
+        emitInsertChildrenEnd(first, last);
+
+        first = last;
+    }
+
+    if (children_.size() != targetChildren.size())
+        return std::unexpected(QString("synchronize: children count mismatch"));
+
+    for (auto const i: keptRows)
+        if (auto result = children_[i]->synchronize(targetChildren[i]); !result)
+            return result;
+
+    return {};
+}
+
+void NodeShadow::connectTarget(Node &target) {
+    ZoneScoped;
+
+    connect(&target, &Node::dataChanged, this, [this]{
+        ZoneScoped;
+        icons_.reset();
+        if (auto owner = owner_.lock())
+            emit owner->dataChanged();
+        else
+            emit dataChanged();
+    });
+
+    connect(&target, &Node::aboutToRemove, this, [this]{
+        ZoneScoped;
+        // NOTE: in contrast to other signals, which forward do subtreeRootOwner (if set), this signal does not.
+        //       the reason is, in contrast to other operations, removal of the link's target shouldn't lead to
+        //       the removal of the link itself
+        emit targetAboutToRemove();
+    });
+
+    connect(&target, &Node::insertChildrenEnd, this, [this](int const first, int const last){
+        ZoneScoped;
+
+        // we can only do our insertions after the target has completed its
+        emitInsertChildrenBegin(first, last);
+        // TODO[C++23]
+        /*auto &&rg = std::views::repeat(nullptr)
+                | std::views::take(last - first + 1);
+        children_.insert_range(children_.begin() + first, rg);*/
+        bool complete = true;
+        for (int row = first; row <= last; ++row) {
+            if (auto child = createChild(row); !child) {
+                qCCritical(LoggingCategory) << "Could not create a children in a linking subtree; subtree will get rendered inconsitently:" << child.error();
+                complete = false;
+            } else {
+                children_.emplace(children_.begin() + row, std::move(*child));
+            }
+        }
+        if (complete)
+            childrenInserted(first, last);
+        else
+            childrenChanged();
+        emitInsertChildrenEnd(first, last);
+    });
+
+    connect(&target, &Node::beforeRemoveChildren, this, [this](int const first, int const last) {
+        ZoneScoped;
+
+        // we must do our removals before the target has completed its
+        emitRemoveChildrenBegin(first, last);
+        for (auto i = first; i <= last; ++i)
+            children_[i]->deinit();
+        children_.erase(children_.begin() + first, children_.begin() + last + 1);
+        childrenRemoved(first, last);
+        emitRemoveChildrenEnd(first, last);
+    });
+}
+
+void NodeShadow::invalidateReplacingRowTable() const {
+    // children of a shadow root are displayed in place of its owner
+    if (auto owner = owner_.lock())
+        owner->invalidateReplacingRowTable();
+}
+
+// row changes are reported by the owner if there's one, as the shadow root is not visible in the model
+void NodeShadow::emitInsertChildrenBegin(int const first, int const last) {
+    if (auto owner = owner_.lock())
+        emit owner->insertChildrenBegin(first, last);
+    else
+        emit insertChildrenBegin(first, last);
+}
+
+void NodeShadow::emitInsertChildrenEnd(int const first, int const last) {
+    if (auto owner = owner_.lock())
+        emit owner->insertChildrenEnd(first, last);
+    else
+        emit insertChildrenEnd(first, last);
+}
+
+void NodeShadow::emitRemoveChildrenBegin(int const first, int const last) {
+    if (auto owner = owner_.lock())
+        emit owner->removeChildrenBegin(first, last);
+    else
+        emit removeChildrenBegin(first, last);
+}
+
+void NodeShadow::emitRemoveChildrenEnd(int const first, int const last) {
+    if (auto owner = owner_.lock())
+        emit owner->removeChildrenEnd(first, last);
+    else
+        emit removeChildrenEnd(first, last);
+}
+
 std::expected<std::shared_ptr<NodeShadow>, QString> NodeShadow::createChild(int const row) {
     ZoneScoped;
 
@@ -432,6 +624,14 @@ std::expected<std::shared_ptr<NodeShadow>, QString> NodeShadow::createChild(int
     return linkChild;
 }
 
+bool NodeShadow::isShadowRoot() const {
+    return !owner_.expired();
+}
+
+bool NodeShadow::isShadowOf(Node const &node) const {
+    return target_.lock().get() == &node;
+}
+
 std::shared_ptr<Node> NodeShadow::target() const {
     auto target = target_.lock();
     if (!target) {
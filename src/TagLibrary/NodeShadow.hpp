@@ -86,16 +86,34 @@ public:
 
     [[nodiscard]] std::expected<void, QString> repopulateShadows(RepopulationRequest const &repopulationRequest = {}) override;
 
+    void invalidateReplacingRowTable() const override;
+
+    // the root of a linked subtree, owned by a link; it's not a child of any node
+    [[nodiscard]] bool isShadowRoot() const;
+    [[nodiscard]] bool isShadowOf(Node const &node) const;
+
+    // Brings the subtree in line with the target's (possibly recreated) subtree, reporting only the rows that differ.
+    // Shadows of target nodes still present keep their identity. Tags of a retargeted root are to be invalidated by
+    // its owner.
+    [[nodiscard]] std::expected<void, QString> synchronize(std::shared_ptr<Node> const &target);
+
 signals:
     void targetAboutToRemove();
 
 private:
+    [[nodiscard]] std::shared_ptr<Node> unreplacedParent() const override;
     [[nodiscard]] std::expected<std::shared_ptr<NodeShadow>, QString> createChild(int row);
     [[nodiscard]] std::shared_ptr<Node> target() const;
+    void connectTarget(Node &target);
+
+    void emitInsertChildrenBegin(int first, int last);
+    void emitInsertChildrenEnd(int first, int last);
+    void emitRemoveChildrenBegin(int first, int last);
+    void emitRemoveChildrenEnd(int first, int last);
 
     std::weak_ptr<Node> const parent_;
-    std::weak_ptr<Node> const target_;
-    QUuid const targetUuid_;
+    std::weak_ptr<Node> target_;
+    QUuid targetUuid_;
     std::weak_ptr<Node> const owner_;
     std::vector<std::shared_ptr<NodeShadow>> children_;
     mutable std::optional<std::vector<IconIdentifier>> icons_;
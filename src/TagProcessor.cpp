@@ -66,9 +66,233 @@ QString resolveParametrized(QString const &string, QString const &spec) {
 
     return result;
 }
+
+// Tag parsed into literal text and "(name:replacement)" groups. Resolving it with a spec keeps the text, and the
+// replacements of groups named as the spec - same as resolveParametrized(), without re-parsing the tag.
+struct ParametrizedTemplate {
+    struct Part {
+        QString text;
+        std::optional<QString> name; // nullopt for literal text
+    };
+    std::vector<Part> parts;
+};
+
+ParametrizedTemplate compileParametrized(QString const &string) {
+    ZoneScoped;
+
+    ParametrizedTemplate result;
+
+    enum class State { OUTSIDE, IN_NAME, IN_REPL };
+    State state = State::OUTSIDE;
+    QString literal;
+    QString currentName;
+    QString currentRepl;
+
+    for (auto const ch: string) {
+        switch (state) {
+            case State::OUTSIDE:
+                if (ch.unicode() == '(') {
+                    if (!literal.isEmpty())
+                        result.parts.push_back({.text = std::exchange(literal, {}), .name = std::nullopt});
+                    state = State::IN_NAME;
+                } else {
+                    literal += ch;
+                }
+                break;
+            case State::IN_NAME:
+                if (ch.unicode() == ':')
+                    state = State::IN_REPL;
+                else
+                    currentName += ch;
+                break;
+            case State::IN_REPL:
+                if (ch.unicode() == ')') {
+                    result.parts.push_back({.text = std::exchange(currentRepl, {}), .name = std::exchange(currentName, {})});
+                    state = State::OUTSIDE;
+                } else {
+                    currentRepl += ch;
+                }
+                break;
+        }
+    }
+
+    // an unterminated group is dropped
+    if (!literal.isEmpty())
+        result.parts.push_back({.text = literal, .name = std::nullopt});
+
+    return result;
 }
 
-QString resolveChildTag(QString const &parent, QString const &child) {
+QString resolve(ParametrizedTemplate const &compiled, QString const &spec) {
+    qsizetype size = 0;
+    for (auto const &part: compiled.parts)
+        if (!part.name || *part.name == spec)
+            size += part.text.size();
+
+    QString result;
+    result.reserve(size);
+    for (auto const &part: compiled.parts)
+        if (!part.name || *part.name == spec)
+            result += part.text;
+
+    return result;
+}
+
+// Child tag with the parent substitutions ("%", "%(spec)") and its own groups already worked out: the result is the
+// pieces concatenated, each being either literal text or the parent resolved with the given spec.
+struct ChildTemplate {
+    struct Piece {
+        QString text;
+        std::optional<QString> spec; // nullopt for literal text
+    };
+    std::vector<Piece> pieces;
+    // False if a substitution is placed in a group name, so that the outcome depends on the parent. Also assumed by
+    // the pieces is that substituted text doesn't contain parentheses, which is checked when resolving - for all the
+    // specs, including these whose substitutions ended up in dropped groups.
+    bool valid = true;
+    QStringList specs;
+};
+
+ChildTemplate compileChild(QString const &child) {
+    ZoneScoped;
+
+    using Piece = ChildTemplate::Piece;
+    auto appendText = [](std::vector<Piece> &pieces, QChar const ch) {
+        if (pieces.empty() || pieces.back().spec)
+            pieces.push_back({.text = {}, .spec = std::nullopt});
+        pieces.back().text += ch;
+    };
+
+    // first pass of resolveChildTagInterpreted(): split into text and substitutions
+    std::vector<Piece> tokens;
+    {
+        enum class State { OUTSIDE, IN_PARAMS };
+        State state = State::OUTSIDE;
+        QString currentSpec;
+
+        auto ch = child.begin();
+        while (ch != child.end()) {
+            switch (state) {
+                case State::OUTSIDE: {
+                    if (ch->unicode() == '%') {
+                        ++ch;
+
+                        if (ch == child.end()) {
+                            tokens.push_back({.text = {}, .spec = QString()});
+                            break;
+                        }
+
+                        if (ch->unicode() == '(') {
+                            state = State::IN_PARAMS;
+                            ++ch;
+                        } else {
+                            tokens.push_back({.text = {}, .spec = QString()});
+                        }
+                    } else {
+                        appendText(tokens, *ch);
+                        ++ch;
+                    }
+                    break;
+                }
+                case State::IN_PARAMS: {
+                    if (ch->unicode() == ')') {
+                        tokens.push_back({.text = {}, .spec = std::exchange(currentSpec, {})});
+                        state = State::OUTSIDE;
+                    } else {
+                        currentSpec += *ch;
+                    }
+                    ++ch;
+                    break;
+                }
+            }
+        }
+    }
+
+    // second pass, resolveParametrized(result, ""), with the substitutions taken as opaque text
+    ChildTemplate result;
+    for (auto const &token: tokens)
+        if (token.spec && !result.specs.contains(*token.spec))
+            result.specs.append(*token.spec);
+    {
+        enum class State { OUTSIDE, IN_NAME, IN_REPL };
+        State state = State::OUTSIDE;
+        QString currentName;
+        std::vector<Piece> currentRepl;
+
+        for (auto const &token: tokens) {
+            if (token.spec) {
+                switch (state) {
+                    case State::OUTSIDE:
+                        result.pieces.push_back(token);
+                        break;
+                    case State::IN_NAME:
+                        result.valid = false;
+                        return result;
+                    case State::IN_REPL:
+                        currentRepl.push_back(token);
+                        break;
+                }
+                continue;
+            }
+
+            for (auto const ch: token.text) {
+                switch (state) {
+                    case State::OUTSIDE:
+                        if (ch.unicode() == '(')
+                            state = State::IN_NAME;
+                        else
+                            appendText(result.pieces, ch);
+                        break;
+                    case State::IN_NAME:
+                        if (ch.unicode() == ':')
+                            state = State::IN_REPL;
+                        else
+                            currentName += ch;
+                        break;
+                    case State::IN_REPL:
+                        if (ch.unicode() == ')') {
+                            if (currentName.isEmpty()) {
+                                for (auto &piece: currentRepl) {
+                                    if (piece.spec)
+                                        result.pieces.push_back(std::move(piece));
+                                    else
+                                        for (auto const replCh: piece.text)
+                                            appendText(result.pieces, replCh);
+                                }
+                            }
+                            currentName.clear();
+                            currentRepl.clear();
+                            state = State::OUTSIDE;
+                        } else {
+                            appendText(currentRepl, ch);
+                        }
+                        break;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+// Compiled templates and memoized results. Shared by all threads, cleared as a whole when it grows too big.
+struct Cache {
+    static constexpr qsizetype MAX_ENTRIES = 1 << 16;
+
+    QMutex mutex;
+    // shared, so that they're used after the mutex is released
+    QHash<QString, std::shared_ptr<ParametrizedTemplate const>> parents;
+    QHash<QString, std::shared_ptr<ChildTemplate const>> children;
+    QHash<std::pair<QString, QString>, QString> results;
+};
+
+Cache &cache() {
+    static Cache cache;
+    return cache;
+}
+}
+
+QString resolveChildTagInterpreted(QString const &parent, QString const &child) {
     ZoneScoped;
 
     QString result;
@@ -119,4 +343,72 @@ QString resolveChildTag(QString const &parent, QString const &child) {
 
     return resolveParametrized(result, "");
 }
+
+QString resolveChildTag(QString const &parent, QString const &child) {
+    ZoneScoped;
+
+    auto &cache = TagProcessor::cache();
+
+    // only lookups and insertions are done under the lock, compilation and resolution run concurrently; a template
+    // compiled by two threads at once is just inserted twice
+    auto key = std::pair(parent, child);
+    std::shared_ptr<ChildTemplate const> childTemplate;
+    std::shared_ptr<ParametrizedTemplate const> parentTemplate;
+    {
+        QMutexLocker locker(&cache.mutex);
+
+        if (auto it = cache.results.constFind(key); it != cache.results.cend())
+            return *it;
+
+        childTemplate = cache.children.value(child);
+        parentTemplate = cache.parents.value(parent);
+    }
+
+    if (!childTemplate)
+        childTemplate = std::make_shared<ChildTemplate const>(compileChild(child));
+
+    auto result = [&]{
+        if (!childTemplate->valid)
+            return resolveChildTagInterpreted(parent, child);
+
+        if (!parentTemplate)
+            parentTemplate = std::make_shared<ParametrizedTemplate const>(compileParametrized(parent));
+
+        for (auto const &spec: childTemplate->specs)
+            if (auto substitution = resolve(*parentTemplate, spec); substitution.contains('(') || substitution.contains(')'))
+                return resolveChildTagInterpreted(parent, child);
+
+        // parent substitutions are few (usually just one), so they're resolved up front to size the result
+        std::vector<QString> substitutions;
+        qsizetype size = 0;
+        for (auto const &piece: childTemplate->pieces) {
+            if (piece.spec)
+                size += substitutions.emplace_back(resolve(*parentTemplate, *piece.spec)).size();
+            else
+                size += piece.text.size();
+        }
+
+        QString result;
+        result.reserve(size);
+        auto substitution = substitutions.begin();
+        for (auto const &piece: childTemplate->pieces)
+            result += piece.spec ? *substitution++ : piece.text;
+        return result;
+    }();
+
+    QMutexLocker locker(&cache.mutex);
+
+    if (cache.results.size() >= Cache::MAX_ENTRIES)
+        cache.results.clear();
+    if (cache.parents.size() >= Cache::MAX_ENTRIES)
+        cache.parents.clear();
+    if (cache.children.size() >= Cache::MAX_ENTRIES)
+        cache.children.clear();
+
+    cache.children.insert(child, childTemplate);
+    if (parentTemplate)
+        cache.parents.insert(parent, parentTemplate);
+    cache.results.insert(key, result);
+    return result;
+}
 }
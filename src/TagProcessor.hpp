@@ -17,5 +17,8 @@
 #pragma once
 
 namespace TagProcessor {
+// Tags are compiled into templates on first use, and results are memoized, so repeated calls are cheap.
 QString resolveChildTag(QString const &parent, QString const &child);
+// Same result, but parsing both tags on every call. Used where templates can't express the result, and as reference.
+QString resolveChildTagInterpreted(QString const &parent, QString const &child);
 };
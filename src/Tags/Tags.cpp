@@ -55,7 +55,7 @@ std::expected<void, QString> Tags::init(FileEditor &fileEditor) {
 
     connect(&fileEditor, &FileEditor::tagsChanged, this, [&]{
         ZoneScoped;
-        if (auto size = fileEditor.assignedTags()->size(); size == 0)
+        if (auto size = fileEditor.assignedTagIds()->size(); size == 0)
             ui->labelAssignedTags->setText(tr("Assigned tags:"));
         else
             ui->labelAssignedTags->setText(tr("Assigned tags (%1):").arg(size));
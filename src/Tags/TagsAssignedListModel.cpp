@@ -41,7 +41,7 @@ bool TagsAssignedListModel::canDropMimeData(const QMimeData *data, Qt::DropActio
 int TagsAssignedListModel::rowCount(const QModelIndex &parent) const {
     ZoneScoped;
     gsl_Expects(!parent.isValid());
-    return fileEditor_.assignedTags().transform([](auto const &v){ return v.size(); }).value_or(0);
+    return fileEditor_.hasFile() ? fileEditor_.assignedTagIds().size() : 0;
 }
 
 Qt::ItemFlags TagsAssignedListModel::flags(QModelIndex const &index) const {
@@ -60,17 +60,15 @@ Qt::ItemFlags TagsAssignedListModel::flags(QModelIndex const &index) const {
 QVariant TagsAssignedListModel::data(const QModelIndex &index, int role) const {
     ZoneScoped;
 
-    if (!index.isValid() || index.parent().isValid())
+    if (!index.isValid() || index.parent().isValid() || !fileEditor_.hasFile())
         return {};
 
-    auto tag = fileEditor_.assignedTags()
-            .transform([&](auto const &v)->QVariant{ return v.at(index.row()); })
-            .value_or(QVariant());
+    auto tag = fileEditor_.assignedTagIds().at(index.row());
 
     switch (role) {
         case Qt::ItemDataRole::DisplayRole:
         case std::to_underlying(CustomItemDataRole::TagRole):
-            return tag;
+            return TagDictionary::instance().tag(tag);
         case std::to_underlying(CustomItemDataRole::ExtendedBackgroundRole): {
             std::vector<QBrush> result;
             if (highlightedTags_.contains(tag))
@@ -106,26 +104,26 @@ QModelIndexList TagsAssignedListModel::setHighlightedTags(QStringList const &tag
 
     auto previousTags = highlightedTags_;
 
-    highlightedTags_ = tags;
+    highlightedTags_ = TagDictionary::instance().intern(tags);
 
-    auto tagToIndex = [&](QString const &tag)->QModelIndex{
-        if (auto assignedTags = fileEditor_.assignedTags())
-            if (auto pos = assignedTags->indexOf(tag); pos != -1)
+    auto tagToIndex = [&](TagId const tag)->QModelIndex{
+        if (fileEditor_.hasFile())
+            if (auto pos = fileEditor_.assignedTagIds().indexOf(tag); pos != -1)
                 return this->index(pos, 0);
 
         return QModelIndex{};
     };
 
-    auto emitTagUpdate = [&](QString const &tag){
+    auto emitTagUpdate = [&](TagId const tag){
         if (auto idx = tagToIndex(tag); idx.isValid())
             emit dataChanged(idx, idx);
     };
 
-    for (auto const &previousTag: previousTags)
+    for (auto const previousTag: previousTags)
         if (!highlightedTags_.contains(previousTag))
             emitTagUpdate(previousTag);
 
-    for (auto const &newTag: highlightedTags_)
+    for (auto const newTag: highlightedTags_)
         if (!previousTags.contains(newTag))
             emitTagUpdate(newTag);
 
@@ -135,7 +133,8 @@ QModelIndexList TagsAssignedListModel::setHighlightedTags(QStringList const &tag
 }
 
 void TagsAssignedListModel::setKnownTags(QStringList const &tags) {
-    knownTags_ = tags;
+    auto ids = TagDictionary::instance().intern(tags);
+    knownTags_ = QSet<TagId>(ids.begin(), ids.end());
     emit dataChanged(QModelIndex(), QModelIndex());
 }
 }
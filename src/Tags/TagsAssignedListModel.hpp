@@ -15,6 +15,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #pragma once
+#include "../TagDictionary.hpp"
 
 class FileEditor;
 
@@ -39,7 +40,7 @@ public:
 
 private:
     FileEditor &fileEditor_;
-    QStringList highlightedTags_;
-    QStringList knownTags_;
+    TagIdList highlightedTags_;
+    QSet<TagId> knownTags_;
 };
 }
@@ -0,0 +1,537 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmark suite producing machine-readable results, meant for tracking performance between builds. Every benchmark
+// runs on synthetic data generated up front, sized by --scale. Results are written as JSON:
+//
+//   {
+//     "version": 1, "scale": 1, "iterations": 5, "qtVersion": "6.8.0", "build": "release",
+//     "benchmarks": [
+//       {"name": "model/allTags", "parameters": {...}, "samplesNs": [...],
+//        "minNs": 0, "medianNs": 0, "meanNs": 0, "maxNs": 0},
+//       {"name": "...", "parameters": {...}, "error": "..."}
+//     ]
+//   }
+
+#include "synthetic.hpp"
+
+#include "../src/DirectoryStats.hpp"
+#include "../src/DirectoryStatsManager.hpp"
+#include "../src/FileTagsManager.hpp"
+#include "../src/Project.hpp"
+#include "../src/TagProcessor.hpp"
+#include "../src/FileBrowser/Thumbnail.hpp"
+#include "../src/TagLibrary/Library.hpp"
+#include "../src/TagLibrary/Model.hpp"
+
+namespace {
+    constexpr int REPORT_VERSION = 1;
+
+    // sizes of the datasets at scale 1, all of them grow linearly with the scale
+    constexpr int TAG_PAIRS = 10000;
+    constexpr int LIBRARY_COLLECTIONS = 100;
+    constexpr int PROJECT_DIRECTORIES = 4;
+    constexpr int TAGS_PER_SELECTION = 20;
+    constexpr int SELECTIONS = 4;
+    constexpr int THUMBNAIL_IMAGES = 8;
+
+    constexpr QSize THUMBNAIL_IMAGE_SIZE{3000, 2000};
+    constexpr int THUMBNAIL_HEIGHT = 80;
+
+    // the datasets are random, but the same between runs
+    constexpr quint32 SEED = 1;
+
+    QStringList const TAG_LIBRARY_BENCHMARKS{
+        "library/load", "library/save", "model/allTags", "model/setTagsActive", "model/setHighlightedTags"
+    };
+    QStringList const PROJECT_BENCHMARKS{"fileTags/load", "fileTags/save", "directoryStats/fullScan"};
+
+    // parametrized objects with a single child object, whose tags have to be resolved against the parent's
+    Synthetic::LibraryOptions libraryOptions(int const scale) {
+        return {
+            .collections = LIBRARY_COLLECTIONS * scale,
+            .objectsPerCollection = 50,
+            .depth = 2,
+            .fanOut = 1,
+            .tagsPerObject = 2
+        };
+    }
+
+    Synthetic::ProjectOptions projectOptions(int const scale) {
+        return {
+            .directories = PROJECT_DIRECTORIES * scale,
+            .subdirectories = 5,
+            .imagesPerDirectory = 50,
+            .minTagsPerImage = 8,
+            .maxTagsPerImage = 8,
+            .unknownTagProbability = 0.1,
+            .completeProbability = 0.5
+        };
+    }
+
+    QJsonObject toJson(Synthetic::LibraryOptions const &options) {
+        return {
+            {"collections", options.collections},
+            {"objectsPerCollection", options.objectsPerCollection},
+            {"depth", options.depth},
+            {"fanOut", options.fanOut},
+            {"tagsPerObject", options.tagsPerObject}
+        };
+    }
+
+    using Step = std::function<std::expected<void, QString>()>;
+
+    struct Options {
+        int scale = 1;
+        int iterations = 5;
+        QRegularExpression filter;
+    };
+
+    class Harness {
+    public:
+        explicit Harness(Options options): options_(std::move(options)) {}
+
+        [[nodiscard]] bool enabled(QString const &name) const {
+            return options_.filter.match(name).hasMatch();
+        }
+
+        [[nodiscard]] bool anyEnabled(QStringList const &names) const {
+            return std::ranges::any_of(names, [this](auto const &name){ return enabled(name); });
+        }
+
+        // Times the given number of runs of `body`. `setup` is called before each of them, outside of the timed
+        // section. An error from either of them stops the benchmark, and is recorded in its result.
+        void run(QString const &name, QJsonObject const &parameters, Step const &setup, Step const &body) {
+            ZoneScoped;
+
+            if (!enabled(name))
+                return;
+
+            qInfo().noquote() << "Running" << name;
+
+            QJsonObject result{{"name", name}, {"parameters", parameters}};
+            auto fail = [&](QString const &error) {
+                qWarning().noquote() << name << "failed:" << error;
+                result["error"] = error;
+                results_.append(result);
+                failed_ = true;
+            };
+
+            QList<qint64> samples;
+            for (int i = 0; i != options_.iterations; ++i) {
+                if (auto setupResult = setup(); !setupResult)
+                    return fail(setupResult.error());
+
+                QElapsedTimer timer;
+                timer.start();
+                auto bodyResult = body();
+                auto elapsed = timer.nsecsElapsed();
+
+                if (!bodyResult)
+                    return fail(bodyResult.error());
+                samples.append(elapsed);
+            }
+
+            auto sorted = samples;
+            std::ranges::sort(sorted);
+
+            QJsonArray samplesNs;
+            for (auto const sample: samples)
+                samplesNs.append(sample);
+
+            result["samplesNs"] = samplesNs;
+            result["minNs"] = sorted.first();
+            result["medianNs"] = sorted[sorted.size() / 2];
+            result["meanNs"] = std::ranges::fold_left(sorted, qint64{0}, std::plus{}) / sorted.size();
+            result["maxNs"] = sorted.last();
+            results_.append(result);
+        }
+
+        void run(QString const &name, QJsonObject const &parameters, Step const &body) {
+            run(name, parameters, []{ return std::expected<void, QString>{}; }, body);
+        }
+
+        [[nodiscard]] QJsonObject report() const {
+            return {
+                {"version", REPORT_VERSION},
+                {"scale", options_.scale},
+                {"iterations", options_.iterations},
+                {"qtVersion", qVersion()},
+#ifdef NDEBUG
+                {"build", "release"},
+#else
+                {"build", "debug"},
+#endif
+                {"benchmarks", results_}
+            };
+        }
+
+        [[nodiscard]] bool failed() const {
+            return failed_;
+        }
+
+    private:
+        Options options_;
+        QJsonArray results_;
+        bool failed_ = false;
+    };
+
+    QStringList pick(QStringList const &from, int const count, QRandomGenerator &random) {
+        QStringList picked;
+        for (int i = 0; i != count && !from.empty(); ++i)
+            picked.append(from[random.bounded(static_cast<int>(from.size()))]);
+        return picked;
+    }
+
+    void benchmarkTagProcessor(Harness &harness, int const scale) {
+        ZoneScoped;
+
+        if (!harness.anyEnabled({"tagProcessor/resolveChildTag", "tagProcessor/resolveChildTagInterpreted"}))
+            return;
+
+        QStringList const parents{"human", "female(plural:s)", "wom(:a)(plural:e)n", "% on (own:own )(anothers:another's )hip"};
+        QStringList const children{"one %", "two %(plural)", "%(own)", "%(anothers)"};
+
+        // Distinct pairs, new ones for every run, so that the results memoized by the previous runs don't turn the
+        // following ones into mere lookups. Generating them isn't timed.
+        auto count = TAG_PAIRS * scale;
+        int generation = 0;
+        QList<std::pair<QString, QString>> pairs;
+        auto generate = [&] -> std::expected<void, QString> {
+            pairs.clear();
+            for (int i = 0; i != count; ++i) {
+                auto n = generation * count + i;
+                pairs.append({QString("%1 %2").arg(parents[i % parents.size()]).arg(n), children[(i / parents.size()) % children.size()]});
+            }
+            ++generation;
+            return {};
+        };
+
+        QJsonObject parameters{{"pairs", count}};
+
+        auto resolve = [&](auto const &function) -> std::expected<void, QString> {
+            qsizetype total = 0;
+            for (auto const &[parent, child]: pairs)
+                total += function(parent, child).size();
+            if (total == 0)
+                return std::unexpected(QString("All tags resolved to empty strings"));
+            return {};
+        };
+
+        harness.run("tagProcessor/resolveChildTag", parameters, generate, [&]{
+            return resolve(&TagProcessor::resolveChildTag);
+        });
+        harness.run("tagProcessor/resolveChildTagInterpreted", parameters, generate, [&]{
+            return resolve(&TagProcessor::resolveChildTagInterpreted);
+        });
+    }
+
+    void benchmarkTagLibrary(Harness &harness, int const scale, QCborValue const &root) {
+        ZoneScoped;
+
+        if (!harness.anyEnabled(TAG_LIBRARY_BENCHMARKS))
+            return;
+
+        auto parameters = toJson(libraryOptions(scale));
+
+        if (harness.anyEnabled({"library/load", "library/save"})) {
+            auto library = TagLibrary::Library::create({});
+            if (!library) {
+                qWarning().noquote() << "Could not create tag library:" << library.error();
+                return;
+            }
+
+            auto content = Synthetic::makeLibraryContent(root);
+
+            harness.run("library/load", parameters, [&] -> std::expected<void, QString> {
+                QBuffer buffer;
+                buffer.setData(content);
+                return (*library)->loadContent(buffer);
+            });
+
+            harness.run("library/save", parameters, [&] -> std::expected<void, QString> {
+                QBuffer buffer;
+                return (*library)->saveContent(buffer);
+            });
+        }
+
+        TagLibrary::Model model;
+        if (auto result = model.resetRoot().and_then([&]{ return model.load(root); }); !result) {
+            qWarning().noquote() << "Could not load tag library model:" << result.error();
+            return;
+        }
+
+        auto reload = [&]{ return model.load(root); };
+
+        // full scan, the cached tags are dropped by the reload
+        harness.run("model/allTags", parameters, reload, [&] -> std::expected<void, QString> {
+            if (model.allTags().empty())
+                return std::unexpected(QString("No tags in the library"));
+            return {};
+        });
+
+        // sorted, so that the selections don't depend on how the model orders its tags
+        QRandomGenerator random(SEED);
+        auto allTags = model.allTags();
+        allTags.sort();
+        QList<QStringList> selections;
+        for (int i = 0; i != SELECTIONS; ++i)
+            selections.append(pick(allTags, TAGS_PER_SELECTION, random));
+
+        // a different selection each time, like when moving between images
+        auto selectionParameters = parameters;
+        selectionParameters["tagsPerSelection"] = TAGS_PER_SELECTION;
+
+        int selection = 0;
+        harness.run("model/setTagsActive", selectionParameters, [&]{
+            return model.setTagsActive(selections[selection++ % selections.size()]);
+        });
+
+        selection = 0;
+        harness.run("model/setHighlightedTags", selectionParameters, [&] -> std::expected<void, QString> {
+            if (auto result = model.setHighlightedTags(selections[selection++ % selections.size()]); !result)
+                return std::unexpected(result.error());
+            return {};
+        });
+    }
+
+    void benchmarkProject(Harness &harness, int const scale, QCborValue const &root) {
+        ZoneScoped;
+
+        if (!harness.anyEnabled(PROJECT_BENCHMARKS))
+            return;
+
+        auto fail = [](QString const &error) {
+            qWarning().noquote() << "Could not create project dataset:" << error;
+        };
+
+        QTemporaryDir dir;
+        if (!dir.isValid())
+            return fail(dir.errorString());
+
+        auto library = TagLibrary::Library::create({});
+        if (!library)
+            return fail(library.error());
+
+        QBuffer buffer;
+        buffer.setData(Synthetic::makeLibraryContent(root));
+        if (auto result = (*library)->loadContent(buffer); !result)
+            return fail(result.error());
+
+        QRandomGenerator random(SEED);
+        auto options = projectOptions(scale);
+        auto images = Synthetic::makeProject(dir.path(), options, **library, random);
+        if (!images)
+            return fail(images.error());
+
+        auto project = Project::open(Synthetic::projectFilePath(dir.path()));
+        if (!project)
+            return fail(project.error());
+
+        QJsonObject parameters{
+            {"directories", options.directories * (1 + options.subdirectories)},
+            {"images", static_cast<qint64>(images->size())},
+            {"tagsPerImage", options.maxTagsPerImage}
+        };
+
+        // every run starts with empty caches, the same as after opening the project
+        std::unique_ptr<DirectoryStatsManager> directoryStatsManager;
+        std::unique_ptr<FileTagsManager> fileTagsManager;
+        auto resetManagers = [&] -> std::expected<void, QString> {
+            directoryStatsManager.reset();
+            fileTagsManager = std::make_unique<FileTagsManager>(false);
+            fileTagsManager->setTagLibrary(&**library);
+            return {};
+        };
+
+        harness.run("fileTags/load", parameters, resetManagers, [&] -> std::expected<void, QString> {
+            for (auto const &image: *images)
+                if (auto fileTags = fileTagsManager->forFile(image); !fileTags)
+                    return std::unexpected(fileTags.error());
+            return {};
+        });
+
+        bool toggle = false;
+        QList<std::shared_ptr<FileTags>> modified;
+        // outlives the manager, which reports the results of its saves through a signal
+        std::optional<QString> saveError;
+        harness.run("fileTags/save", parameters, [&] -> std::expected<void, QString> {
+            // tags refer to the manager they were loaded by
+            modified.clear();
+            if (auto result = resetManagers(); !result)
+                return result;
+
+            toggle = !toggle;
+            for (auto const &image: *images) {
+                auto fileTags = fileTagsManager->forFile(image);
+                if (!fileTags)
+                    return std::unexpected(fileTags.error());
+                std::ignore = (*fileTags)->setTags({"toggled"}, toggle);
+                modified.append(*fileTags);
+            }
+            return {};
+        }, [&] -> std::expected<void, QString> {
+            saveError.reset();
+            QObject::connect(&*fileTagsManager, &FileTagsManager::tagsSaved, [&](auto const &, auto const &result){
+                if (!result && !saveError)
+                    saveError = result.error();
+            });
+
+            for (auto &fileTags: modified)
+                if (auto result = fileTags->save(); !result)
+                    return result;
+
+            // saves are queued, measure them until they're on disk
+            fileTagsManager->flushSaves();
+            if (saveError)
+                return std::unexpected(*saveError);
+            return {};
+        });
+        modified.clear();
+
+        harness.run("directoryStats/fullScan", parameters, [&] -> std::expected<void, QString> {
+            if (auto result = resetManagers(); !result)
+                return result;
+
+            directoryStatsManager = std::make_unique<DirectoryStatsManager>(*fileTagsManager);
+            directoryStatsManager->setProject(&*project);
+            directoryStatsManager->setTagLibrary(&**library);
+            return {};
+        }, [&] -> std::expected<void, QString> {
+            auto &stats = directoryStatsManager->directoryStats(QDir(dir.path()).absolutePath());
+            while (!stats.ready()) {
+                QCoreApplication::processEvents();
+                QThread::yieldCurrentThread();
+            }
+
+            if (stats.fileCount() != images->size())
+                return std::unexpected(QString("Counted %1 files instead of %2").arg(stats.fileCount()).arg(images->size()));
+            return {};
+        });
+
+        directoryStatsManager.reset();
+        fileTagsManager.reset();
+    }
+
+    void benchmarkThumbnail(Harness &harness, int const scale) {
+        ZoneScoped;
+
+        if (!harness.anyEnabled({"thumbnail/load", "thumbnail/loadFullDecode"}))
+            return;
+
+        QTemporaryDir dir;
+        if (!dir.isValid()) {
+            qWarning().noquote() << "Could not create thumbnail dataset:" << dir.errorString();
+            return;
+        }
+
+        QStringList images;
+        QImage image(THUMBNAIL_IMAGE_SIZE, QImage::Format::Format_RGB32);
+        for (int i = 0; i != THUMBNAIL_IMAGES * scale; ++i) {
+            for (int y = 0; y < image.height(); ++y) {
+                auto line = reinterpret_cast<QRgb *>(image.scanLine(y));
+                for (int x = 0; x < image.width(); ++x)
+                    line[x] = qRgb((x * (i + 1)) % 256, (y * (i + 2)) % 256, ((x ^ y) + i) % 256);
+            }
+
+            auto path = dir.filePath(QString("image%1.jpg").arg(i));
+            if (!image.save(path, "JPG", 90)) {
+                qWarning().noquote() << "Could not save thumbnail dataset image" << path;
+                return;
+            }
+            images.append(path);
+        }
+
+        QJsonObject parameters{
+            {"images", static_cast<qint64>(images.size())},
+            {"imageWidth", THUMBNAIL_IMAGE_SIZE.width()},
+            {"imageHeight", THUMBNAIL_IMAGE_SIZE.height()},
+            {"thumbnailHeight", THUMBNAIL_HEIGHT}
+        };
+
+        auto load = [&](auto const &function) -> std::expected<void, QString> {
+            for (auto const &path: images)
+                if (function(path, THUMBNAIL_HEIGHT).isNull())
+                    return std::unexpected(QString("Could not load thumbnail of %1").arg(path));
+            return {};
+        };
+
+        harness.run("thumbnail/load", parameters, [&]{ return load(&FileBrowser::loadThumbnail); });
+        harness.run("thumbnail/loadFullDecode", parameters, [&]{ return load(&FileBrowser::loadThumbnailFullDecode); });
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // tag library is a widget, but nothing is ever shown
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    app.setApplicationName("simpletagger-cxx-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("SimpleTagger benchmarks");
+    parser.addHelpOption();
+
+    QCommandLineOption scaleOption("scale", "Size of the synthetic datasets, as a multiple of the default one", "factor", "1");
+    QCommandLineOption iterationsOption("iterations", "Number of timed runs of each benchmark", "count", "5");
+    QCommandLineOption filterOption("filter", "Run only benchmarks with names matching the regular expression", "regex", ".*");
+    QCommandLineOption outputOption("output", "Write JSON results to the file instead of the standard output", "file");
+    parser.addOptions({scaleOption, iterationsOption, filterOption, outputOption});
+
+    parser.process(app);
+
+    Options options;
+    bool scaleValid = false, iterationsValid = false;
+    options.scale = parser.value(scaleOption).toInt(&scaleValid);
+    options.iterations = parser.value(iterationsOption).toInt(&iterationsValid);
+    options.filter = QRegularExpression(parser.value(filterOption));
+
+    if (!scaleValid || options.scale < 1)
+        qFatal() << "Invalid scale:" << parser.value(scaleOption);
+    if (!iterationsValid || options.iterations < 1)
+        qFatal() << "Invalid number of iterations:" << parser.value(iterationsOption);
+    if (!options.filter.isValid())
+        qFatal() << "Invalid filter:" << options.filter.errorString();
+
+    Harness harness(options);
+
+    benchmarkTagProcessor(harness, options.scale);
+
+    if (harness.anyEnabled(TAG_LIBRARY_BENCHMARKS + PROJECT_BENCHMARKS)) {
+        QRandomGenerator random(SEED);
+        auto root = Synthetic::makeLibraryRoot(libraryOptions(options.scale), random);
+        if (!root)
+            qFatal() << "Could not create tag library dataset:" << root.error();
+
+        benchmarkTagLibrary(harness, options.scale, *root);
+        benchmarkProject(harness, options.scale, *root);
+    }
+
+    benchmarkThumbnail(harness, options.scale);
+
+    auto json = QJsonDocument(harness.report()).toJson();
+    if (parser.isSet(outputOption)) {
+        QSaveFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit())
+            qFatal() << "Could not write" << parser.value(outputOption) << ":" << file.errorString();
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return harness.failed() ? 1 : 0;
+}
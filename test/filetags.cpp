@@ -0,0 +1,191 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "../src/Constants.hpp"
+#include "../src/FileTagsManager.hpp"
+
+namespace {
+// Writes the tags file of the image in the format FileTags saves (keys as in FileTagsManager.cpp).
+bool writeTagsFile(QString const &imagePath, QByteArray const &content) {
+    QFile file(imagePath + Constants::TAGS_FILE_SUFFIX.toString());
+    return file.open(QIODevice::WriteOnly) && file.write(content) == content.size();
+}
+
+bool writeTagsFile(QString const &imagePath, QStringList const &tags) {
+    QCborMap map;
+    map[1] = 1;
+    map[2] = QString("SIMPLETAGGER-CXX");
+    map[3] = QCborArray::fromStringList(tags);
+    return writeTagsFile(imagePath, map.toCborValue().toCbor());
+}
+
+// Images (which don't need to exist) in the directory, each with a tags file holding a single tag.
+QStringList makeImages(QTemporaryDir const &dir, int const count) {
+    QStringList paths;
+    for (int i = 0; i != count; ++i) {
+        auto path = dir.filePath(QString("image%1.jpg").arg(i));
+        if (!writeTagsFile(path, QStringList{QString("tag_%1").arg(i)}))
+            return {};
+        paths.append(path);
+    }
+    return paths;
+}
+}
+
+class TestFileTagsManager: public QObject {
+    Q_OBJECT
+
+private slots:
+    // Threads asking for the same files at once must all get the single instance loaded for each of them.
+    void testConcurrentLoad() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto paths = makeImages(dir, 50);
+        QVERIFY(!paths.isEmpty());
+
+        FileTagsManager manager(false);
+
+        std::vector<std::future<std::vector<std::shared_ptr<FileTags>>>> workers;
+        for (int w = 0; w != 8; ++w) {
+            workers.push_back(std::async(std::launch::async, [&] {
+                std::vector<std::shared_ptr<FileTags>> loaded;
+                for (auto const &path: paths) {
+                    auto fileTags = manager.forFile(path);
+                    loaded.push_back(fileTags ? *fileTags : nullptr);
+                }
+                return loaded;
+            }));
+        }
+
+        std::vector<std::vector<std::shared_ptr<FileTags>>> results;
+        for (auto &worker: workers)
+            results.push_back(worker.get());
+
+        for (int i = 0; i != paths.size(); ++i) {
+            QVERIFY(results.front()[i]);
+            QCOMPARE(results.front()[i]->assignedTags(), QStringList{QString("tag_%1").arg(i)});
+            for (auto const &result: results)
+                QVERIFY(result[i] == results.front()[i]);
+        }
+
+        QCOMPARE(manager.cacheCounters().entries, paths.size());
+    }
+
+    // A load that failed is reported as such, but not cached: the next call loads again.
+    void testFailedLoadRetried() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto path = dir.filePath("image.jpg");
+        QVERIFY(writeTagsFile(path, QByteArray("not a tags file")));
+
+        FileTagsManager manager(false);
+
+        QVERIFY(!manager.forFile(path));
+        QVERIFY(!manager.forFile(path));
+
+        QVERIFY(writeTagsFile(path, QStringList{"fixed"}));
+        auto fileTags = manager.forFile(path);
+        QVERIFY2(fileTags, qPrintable(fileTags.error()));
+        QCOMPARE((*fileTags)->assignedTags(), QStringList{"fixed"});
+    }
+
+    // Tags referenced outside of the cache, or with unsaved changes, stay cached whatever the capacity is; anything
+    // else is evicted.
+    void testPinnedNotEvicted() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto paths = makeImages(dir, 20);
+        QVERIFY(!paths.isEmpty());
+
+        FileTagsManager manager(false);
+
+        auto referenced = manager.forFile(paths[0]);
+        QVERIFY(referenced);
+
+        {
+            auto modified = manager.forFile(paths[1]);
+            QVERIFY(modified);
+            QVERIFY((*modified)->setTags({"unsaved"}, true));
+        }
+
+        for (auto const &path: paths.mid(2))
+            QVERIFY(manager.forFile(path));
+
+        manager.setCacheCapacity(0, 0);
+        QCOMPARE(manager.cacheCounters().entries, qsizetype(2));
+        QVERIFY(manager.cacheCounters().evictions >= quint64(paths.size() - 2));
+
+        // the very same instances, rather than ones loaded anew
+        auto referencedAgain = manager.forFile(paths[0]);
+        QVERIFY(referencedAgain);
+        QVERIFY(*referencedAgain == *referenced);
+
+        auto modifiedAgain = manager.forFile(paths[1]);
+        QVERIFY(modifiedAgain);
+        QVERIFY((*modifiedAgain)->isModified());
+        QVERIFY((*modifiedAgain)->assignedTags().contains("unsaved"));
+
+        // released and reverted, so nothing holds them anymore
+        QVERIFY((*modifiedAgain)->rollbackChanges());
+        modifiedAgain->reset();
+        referencedAgain->reset();
+        referenced->reset();
+        manager.setCacheCapacity(0, 0);
+        QCOMPARE(manager.cacheCounters().entries, qsizetype(0));
+    }
+
+    // Unpinned tags never take more than the capacity, measured in either bytes or entries.
+    void testCapacity() {
+        QFETCH(bool, limitBytes);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto paths = makeImages(dir, 200);
+        QVERIFY(!paths.isEmpty());
+
+        FileTagsManager manager(false);
+
+        // cost of a single entry, to put the byte limit at about the same number of entries
+        QVERIFY(manager.forFile(paths[0]));
+        auto entryBytes = manager.cacheCounters().bytes;
+        QVERIFY(entryBytes > 0);
+
+        constexpr qsizetype capacity = 48;
+        auto capacityBytes = limitBytes ? capacity * entryBytes : std::numeric_limits<qsizetype>::max();
+        auto capacityEntries = limitBytes ? std::numeric_limits<qsizetype>::max() : capacity;
+        manager.setCacheCapacity(capacityBytes, capacityEntries);
+
+        for (auto const &path: paths) {
+            QVERIFY(manager.forFile(path));
+            auto counters = manager.cacheCounters();
+            QVERIFY(counters.bytes <= capacityBytes);
+            QVERIFY(counters.entries <= capacityEntries);
+        }
+
+        QVERIFY(manager.cacheCounters().entries > 0);
+        QVERIFY(manager.cacheCounters().evictions > 0);
+    }
+
+    void testCapacity_data() {
+        QTest::addColumn<bool>("limitBytes");
+
+        QTest::newRow("entries") << false;
+        QTest::newRow("bytes") << true;
+    }
+};
+
+QTEST_GUILESS_MAIN(TestFileTagsManager)
+#include "filetags.moc"
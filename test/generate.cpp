@@ -0,0 +1,172 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Writes a synthetic project with its tag library to disk, for load testing. For example, a 10k files workload:
+//
+//   simpletagger-cxx-generate --output /tmp/load --directories 100 --images-per-directory 100
+//   simpletagger-cxx --tag-library /tmp/load/TagLibrary.cbor
+//
+// and then open /tmp/load/project.simtagproj.
+
+#include "synthetic.hpp"
+
+#include "../src/TagLibrary/Library.hpp"
+
+namespace {
+    std::optional<int> toInt(QString const &value, int const minimum) {
+        bool valid = false;
+        auto result = value.toInt(&valid);
+        return valid && result >= minimum ? std::optional(result) : std::nullopt;
+    }
+
+    std::optional<double> toProbability(QString const &value) {
+        bool valid = false;
+        auto result = value.toDouble(&valid);
+        return valid && result >= 0.0 && result <= 1.0 ? std::optional(result) : std::nullopt;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // tag library is a widget, but nothing is ever shown
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    app.setApplicationName("simpletagger-cxx-generate");
+
+    Synthetic::LibraryOptions libraryOptions;
+    Synthetic::ProjectOptions projectOptions;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes a synthetic SimpleTagger project and tag library");
+    parser.addHelpOption();
+
+    QCommandLineOption outputOption("output", "Directory to write the project to; must not exist or be empty", "directory");
+    QCommandLineOption seedOption("seed", "Seed of the random generator", "number", "1");
+
+    QCommandLineOption directoriesOption("directories", "Number of project directories", "count", QString::number(projectOptions.directories));
+    QCommandLineOption subdirectoriesOption("subdirectories", "Number of subdirectories of each project directory", "count", QString::number(projectOptions.subdirectories));
+    QCommandLineOption imagesOption("images-per-directory", "Number of images in every directory and subdirectory", "count", QString::number(projectOptions.imagesPerDirectory));
+    QCommandLineOption imageSizeOption("image-size", "Size of the placeholder images", "WIDTHxHEIGHT", QString("%1x%2").arg(projectOptions.imageSize.width()).arg(projectOptions.imageSize.height()));
+    QCommandLineOption tagsPerImageOption("tags-per-image", "Range of the number of tags assigned to an image", "MIN-MAX", QString("%1-%2").arg(projectOptions.minTagsPerImage).arg(projectOptions.maxTagsPerImage));
+    QCommandLineOption tagDistributionOption("tag-distribution", "Distribution of the assigned library tags: uniform or zipf", "name", "zipf");
+    QCommandLineOption unknownTagsOption("unknown-tags", "Probability of an assigned tag not being in the library", "probability", QString::number(projectOptions.unknownTagProbability));
+    QCommandLineOption regionsOption("regions", "Probability of an image having a region", "probability", QString::number(projectOptions.regionProbability));
+    QCommandLineOption completeOption("complete", "Probability of an image being flagged complete", "probability", QString::number(projectOptions.completeProbability));
+
+    QCommandLineOption collectionsOption("collections", "Number of tag library collections", "count", QString::number(libraryOptions.collections));
+    QCommandLineOption objectsOption("objects-per-collection", "Number of objects in every collection", "count", QString::number(libraryOptions.objectsPerCollection));
+    QCommandLineOption depthOption("depth", "Levels of objects below a collection", "count", QString::number(libraryOptions.depth));
+    QCommandLineOption fanOutOption("fan-out", "Number of children of every object above the last level", "count", QString::number(libraryOptions.fanOut));
+    QCommandLineOption tagsPerObjectOption("tags-per-object", "Number of tags of every object", "count", QString::number(libraryOptions.tagsPerObject));
+    QCommandLineOption linksOption("links", "Probability of a node below the first level being a link", "probability", QString::number(libraryOptions.linkProbability));
+    QCommandLineOption inheritanceOption("inheritance", "Probability of a node below the first level being an inheritance node", "probability", QString::number(libraryOptions.inheritanceProbability));
+
+    parser.addOptions({
+        outputOption, seedOption,
+        directoriesOption, subdirectoriesOption, imagesOption, imageSizeOption, tagsPerImageOption,
+        tagDistributionOption, unknownTagsOption, regionsOption, completeOption,
+        collectionsOption, objectsOption, depthOption, fanOutOption, tagsPerObjectOption, linksOption, inheritanceOption
+    });
+
+    parser.process(app);
+
+    auto invalid = [&](QCommandLineOption const &option) {
+        qFatal() << "Invalid value of" << option.names().first() << ":" << parser.value(option);
+    };
+
+    auto intValue = [&](QCommandLineOption const &option, int const minimum) {
+        auto value = toInt(parser.value(option), minimum);
+        if (!value)
+            invalid(option);
+        return *value;
+    };
+
+    auto probabilityValue = [&](QCommandLineOption const &option) {
+        auto value = toProbability(parser.value(option));
+        if (!value)
+            invalid(option);
+        return *value;
+    };
+
+    if (!parser.isSet(outputOption))
+        qFatal() << "Output directory is required";
+
+    QDir output(parser.value(outputOption));
+    if (output.exists() && !output.isEmpty())
+        qFatal() << "Output directory is not empty:" << output.path();
+    if (!output.mkpath("."))
+        qFatal() << "Could not create output directory:" << output.path();
+
+    QRandomGenerator random(intValue(seedOption, 0));
+
+    projectOptions.directories = intValue(directoriesOption, 0);
+    projectOptions.subdirectories = intValue(subdirectoriesOption, 0);
+    projectOptions.imagesPerDirectory = intValue(imagesOption, 0);
+
+    if (auto size = parser.value(imageSizeOption).split('x'); size.size() == 2)
+        projectOptions.imageSize = QSize(toInt(size[0], 2).value_or(0), toInt(size[1], 2).value_or(0));
+    if (projectOptions.imageSize.width() < 2 || projectOptions.imageSize.height() < 2)
+        invalid(imageSizeOption);
+
+    if (auto range = parser.value(tagsPerImageOption).split('-'); range.size() == 2) {
+        projectOptions.minTagsPerImage = toInt(range[0], 0).value_or(-1);
+        projectOptions.maxTagsPerImage = toInt(range[1], 0).value_or(-1);
+    } else {
+        projectOptions.minTagsPerImage = projectOptions.maxTagsPerImage = toInt(range[0], 0).value_or(-1);
+    }
+    if (projectOptions.minTagsPerImage < 0 || projectOptions.minTagsPerImage > projectOptions.maxTagsPerImage)
+        invalid(tagsPerImageOption);
+
+    if (auto distribution = parser.value(tagDistributionOption); distribution == "uniform")
+        projectOptions.tagDistribution = Synthetic::TagDistribution::Uniform;
+    else if (distribution == "zipf")
+        projectOptions.tagDistribution = Synthetic::TagDistribution::Zipf;
+    else
+        invalid(tagDistributionOption);
+
+    projectOptions.unknownTagProbability = probabilityValue(unknownTagsOption);
+    projectOptions.regionProbability = probabilityValue(regionsOption);
+    projectOptions.completeProbability = probabilityValue(completeOption);
+
+    libraryOptions.collections = intValue(collectionsOption, 0);
+    libraryOptions.objectsPerCollection = intValue(objectsOption, 0);
+    libraryOptions.depth = intValue(depthOption, 1);
+    libraryOptions.fanOut = intValue(fanOutOption, 0);
+    libraryOptions.tagsPerObject = intValue(tagsPerObjectOption, 0);
+    libraryOptions.linkProbability = probabilityValue(linksOption);
+    libraryOptions.inheritanceProbability = probabilityValue(inheritanceOption);
+    if (libraryOptions.linkProbability + libraryOptions.inheritanceProbability > 1.0)
+        qFatal() << "Link and inheritance probabilities add up to more than 1";
+
+    qInfo() << "Generating tag library";
+    auto libraryPath = output.filePath("TagLibrary.cbor");
+    auto library = Synthetic::makeLibrary(libraryPath, libraryOptions, random);
+    if (!library)
+        qFatal() << "Could not generate tag library:" << library.error();
+
+    qInfo() << "Generating project with" << (*library)->allTags().size() << "library tags";
+    auto images = Synthetic::makeProject(output.path(), projectOptions, **library, random);
+    if (!images)
+        qFatal() << "Could not generate project:" << images.error();
+
+    qInfo().noquote() << "Written" << images->size() << "images to" << output.path();
+    qInfo().noquote() << "Project:" << Synthetic::projectFilePath(output.path());
+    qInfo().noquote() << "Tag library:" << libraryPath;
+
+    return 0;
+}
@@ -81,6 +81,63 @@ private slots:
         QTest::newRow("hand on own hip")       << tagHand << tagOnHip << tagOwn      << "hand on hip" << "hand on own hip";
         QTest::newRow("hand on another's hip") << tagHand << tagOnHip << tagAnothers << "hand on hip" << "hand on another's hip";
     }
+
+    // templates take shortcuts, which have to give the same results as parsing the tags every time
+    void testTagProcessorCompiled() {
+        QFETCH(QString, tagParent);
+        QFETCH(QString, tagChild);
+        QCOMPARE(TagProcessor::resolveChildTag(tagParent, tagChild), TagProcessor::resolveChildTagInterpreted(tagParent, tagChild));
+        // second time from the memo table
+        QCOMPARE(TagProcessor::resolveChildTag(tagParent, tagChild), TagProcessor::resolveChildTagInterpreted(tagParent, tagChild));
+    }
+
+    void testTagProcessorCompiled_data() {
+        QTest::addColumn<QString>("tagParent");
+        QTest::addColumn<QString>("tagChild");
+
+        QTest::newRow("plain") << "human" << "female";
+        QTest::newRow("parent at end") << "wom(:a)(plural:e)n" << "two %";
+        QTest::newRow("parent with spec") << "wom(:a)(plural:e)n" << "two %(plural)";
+        QTest::newRow("percent before text") << "hand" << "%x";
+        QTest::newRow("double percent") << "hand" << "%%";
+        QTest::newRow("unterminated spec") << "hand" << "a %(own";
+        QTest::newRow("unterminated group") << "hand(own:own" << "% b";
+        QTest::newRow("child groups") << "hand" << "% on (own:own )(:any )hip";
+        QTest::newRow("parent in empty group") << "hand" << "(:% )hip";
+        QTest::newRow("parent in named group") << "hand" << "(own:% )hip";
+        QTest::newRow("parent in group name") << "hand" << "(%:x)y";
+        QTest::newRow("parentheses from parent") << "a(x:b(c)d" << "%(x) e";
+        QTest::newRow("closing parenthesis from parent") << "a)b" << "(:%)c";
+        QTest::newRow("parenthesis from parent in dropped group") << ":)b" << "a)b(ab:%";
+    }
+
+    void benchmarkTagProcessor() {
+        QFETCH(bool, compiled);
+        QFETCH(int, parents);
+
+        QStringList parentTags;
+        for (int i = 0; i != parents; ++i)
+            parentTags.append(QString("wom(:a)(plural:e)n %1").arg(i));
+        QStringList childTags{"one %", "two %(plural)", "% on (own:own )(anothers:another's )hip"};
+
+        QBENCHMARK {
+            for (auto const &parent: parentTags)
+                for (auto const &child: childTags)
+                    std::ignore = compiled
+                            ? TagProcessor::resolveChildTag(parent, child)
+                            : TagProcessor::resolveChildTagInterpreted(parent, child);
+        }
+    }
+
+    void benchmarkTagProcessor_data() {
+        QTest::addColumn<bool>("compiled");
+        QTest::addColumn<int>("parents");
+
+        QTest::newRow("interpreted, 100 parents") << false << 100;
+        QTest::newRow("compiled, 100 parents") << true << 100;
+        QTest::newRow("interpreted, 10000 parents") << false << 10000;
+        QTest::newRow("compiled, 10000 parents") << true << 10000;
+    }
 };
 
 QTEST_MAIN(TestTagProcessor)
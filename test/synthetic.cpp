@@ -0,0 +1,280 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "synthetic.hpp"
+
+#include "../src/FileTagsManager.hpp"
+#include "../src/Project.hpp"
+#include "../src/TagLibrary/Format.hpp"
+#include "../src/TagLibrary/Library.hpp"
+#include "../src/TagLibrary/Model.hpp"
+#include "../src/TagLibrary/Node.hpp"
+
+namespace Synthetic {
+namespace {
+    // unknown tags are drawn from a pool of this size, so that they repeat like real typos do
+    constexpr int UNKNOWN_TAGS = 1000;
+
+    // Tags of an object at the given level. Objects below the first level get one tag resolved against their parent's
+    // ones, so that the number of resolved tags grows only linearly with the depth.
+    QStringList objectTags(QString const &path, int const level, int const index, int const count) {
+        QStringList tags;
+        for (int t = 0; t != count; ++t) {
+            if (level > 1 && t == 0)
+                tags.append(index % 2 == 0 ? "% detail" : "two %(plural)");
+            else
+                tags.append(QString("tag_%1_%2(plural:s)").arg(path).arg(t));
+        }
+        return tags;
+    }
+}
+
+std::expected<QCborValue, QString> makeLibraryRoot(LibraryOptions const &options, QRandomGenerator &random) {
+    ZoneScoped;
+    gsl_Expects(options.collections >= 0);
+    gsl_Expects(options.objectsPerCollection >= 0);
+    gsl_Expects(options.depth >= 1);
+    gsl_Expects(options.fanOut >= 0);
+    gsl_Expects(options.tagsPerObject >= 0);
+
+    TagLibrary::Model model;
+    if (auto result = model.resetRoot(); !result)
+        return std::unexpected(result.error());
+
+    // objects of the already completed collections; links pointing at them can't form a cycle
+    std::vector<QUuid> targets;
+    std::vector<QUuid> collectionObjects;
+
+    auto insertChildren = [&](this auto const &self, QModelIndex const &parent, int const level, QString const &path)
+            -> std::expected<void, QString> {
+        auto count = level == 1 ? options.objectsPerCollection : options.fanOut;
+        for (int i = 0; i != count; ++i) {
+            auto childPath = QString("%1_%2").arg(path).arg(i);
+
+            auto roll = random.generateDouble();
+            if (level > 1 && !targets.empty() && roll < options.linkProbability + options.inheritanceProbability) {
+                auto type = roll < options.linkProbability ? TagLibrary::NodeType::Link : TagLibrary::NodeType::Inheritance;
+                auto index = model.insertNode(type, parent);
+                if (!index)
+                    return std::unexpected(index.error());
+
+                auto target = targets[random.bounded(static_cast<quint32>(targets.size()))];
+                if (auto result = model.fromIndex(*index)->setLinkTo(target); !result)
+                    return std::unexpected(result.error());
+                continue;
+            }
+
+            auto index = model.insertNode(TagLibrary::NodeType::Object, parent);
+            if (!index)
+                return std::unexpected(index.error());
+            std::ignore = model.setData(index->siblingAtColumn(0), QString("object %1").arg(childPath));
+            std::ignore = model.setData(index->siblingAtColumn(1), objectTags(childPath, level, i, options.tagsPerObject).join(","));
+            collectionObjects.push_back(model.fromIndex(*index)->uuid());
+
+            if (level < options.depth) {
+                if (auto result = self(*index, level + 1, childPath); !result)
+                    return result;
+            }
+        }
+        return {};
+    };
+
+    auto rootCollection = model.index(0, 0, QModelIndex());
+    for (int c = 0; c != options.collections; ++c) {
+        auto collection = model.insertNode(TagLibrary::NodeType::Collection, rootCollection);
+        if (!collection)
+            return std::unexpected(collection.error());
+        std::ignore = model.setData(collection->siblingAtColumn(0), QString("collection %1").arg(c));
+
+        if (auto result = insertChildren(*collection, 1, QString::number(c)); !result)
+            return std::unexpected(result.error());
+
+        std::ranges::move(collectionObjects, std::back_inserter(targets));
+        collectionObjects.clear();
+    }
+
+    return model.save();
+}
+
+QByteArray makeLibraryContent(QCborValue const &root) {
+    QCborMap map;
+    map[std::to_underlying(TagLibrary::Format::TopLevelKey::FormatVersion)] = TagLibrary::Format::formatVersion;
+    map[std::to_underlying(TagLibrary::Format::TopLevelKey::App)] = TagLibrary::Format::app.toString();
+    map[std::to_underlying(TagLibrary::Format::TopLevelKey::RootNode)] = root;
+    map[std::to_underlying(TagLibrary::Format::TopLevelKey::LibraryUuid)] = QUuid::createUuid().toRfc4122();
+    map[std::to_underlying(TagLibrary::Format::TopLevelKey::LibraryVersion)] = 1;
+    map[std::to_underlying(TagLibrary::Format::TopLevelKey::LibraryVersionUuid)] = QUuid::createUuid().toRfc4122();
+    return map.toCborValue().toCbor();
+}
+
+std::expected<std::unique_ptr<TagLibrary::Library>, QString> makeLibrary(
+        QString const &path,
+        LibraryOptions const &options,
+        QRandomGenerator &random
+) {
+    ZoneScoped;
+
+    auto root = makeLibraryRoot(options, random);
+    if (!root)
+        return std::unexpected(root.error());
+
+    {
+        QSaveFile file(path);
+        auto content = makeLibraryContent(*root);
+        if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+            return std::unexpected(QString("Could not write %1: %2").arg(path, file.errorString()));
+    }
+
+    auto library = TagLibrary::Library::create(path);
+    if (!library)
+        return library;
+
+    QFile file(path);
+    if (auto result = (*library)->loadContent(file); !result)
+        return std::unexpected(result.error());
+    return library;
+}
+
+std::expected<QStringList, QString> makeProject(
+        QString const &rootDir,
+        ProjectOptions const &options,
+        TagLibrary::Library &library,
+        QRandomGenerator &random
+) {
+    ZoneScoped;
+    gsl_Expects(options.directories >= 0);
+    gsl_Expects(options.subdirectories >= 0);
+    gsl_Expects(options.imagesPerDirectory >= 0);
+    gsl_Expects(options.imageSize.width() >= 2 && options.imageSize.height() >= 2);
+    gsl_Expects(options.minTagsPerImage >= 0 && options.minTagsPerImage <= options.maxTagsPerImage);
+
+    auto projectPath = projectFilePath(rootDir);
+    if (auto result = Project::create(projectPath); !result)
+        return std::unexpected(result.error());
+
+    auto project = Project::open(projectPath);
+    if (!project)
+        return std::unexpected(project.error());
+
+    // in the order the tags first appear in the library, which for a library that was just loaded depends only on its
+    // content, so that the same tags get the same ranks on every run
+    auto libraryTags = library.allTags();
+
+    // cumulative weights of the library tags, in that order
+    std::vector<double> weights;
+    double sum = 0;
+    for (int k = 0; k != libraryTags.size(); ++k) {
+        sum += options.tagDistribution == TagDistribution::Zipf ? 1.0 / (k + 1) : 1.0;
+        weights.push_back(sum);
+    }
+
+    auto pickTag = [&] -> QString {
+        if (libraryTags.empty() || random.generateDouble() < options.unknownTagProbability)
+            return QString("unknown_%1").arg(random.bounded(UNKNOWN_TAGS));
+
+        auto k = std::ranges::upper_bound(weights, random.generateDouble() * sum) - weights.begin();
+        return libraryTags[std::min<qsizetype>(k, libraryTags.size() - 1)];
+    };
+
+    auto randomRegion = [&] {
+        auto x = random.bounded(options.imageSize.width() / 2);
+        auto y = random.bounded(options.imageSize.height() / 2);
+        return QRect(
+                x, y,
+                1 + random.bounded(options.imageSize.width() - x), 1 + random.bounded(options.imageSize.height() - y)
+        );
+    };
+
+    QStringList images;
+    for (int d = 0; d != options.directories; ++d) {
+        auto projectDirectory = QString("directory %1").arg(d);
+        if (auto result = project->addDirectory(projectDirectory); !result)
+            return std::unexpected(result.error());
+
+        QStringList directories{QDir(rootDir).absoluteFilePath(projectDirectory)};
+        for (int s = 0; s != options.subdirectories; ++s)
+            directories.append(QDir(directories.first()).filePath(QString("subdirectory %1").arg(s)));
+
+        for (auto const &directory: directories) {
+            if (!QDir().mkpath(directory))
+                return std::unexpected(QString("Could not create directory %1").arg(directory));
+
+            // the same image in the whole directory, in a colour of its own
+            QImage image(options.imageSize, QImage::Format::Format_RGB32);
+            image.fill(QColor::fromRgb(random.bounded(256), random.bounded(256), random.bounded(256)));
+
+            QByteArray placeholder;
+            QBuffer buffer(&placeholder);
+            if (!buffer.open(QIODevice::WriteOnly) || !image.save(&buffer, "JPG"))
+                return std::unexpected(QString("Could not encode placeholder image"));
+
+            // per directory, so that the cached tags don't accumulate over the whole project
+            FileTagsManager fileTagsManager(false);
+            fileTagsManager.setTagLibrary(&library);
+
+            // saves are written in the background, failures only come back through the signal
+            std::optional<QString> saveError;
+            QObject::connect(&fileTagsManager, &FileTagsManager::tagsSaved, [&](auto const &, auto const &result){
+                if (!result && !saveError)
+                    saveError = result.error();
+            });
+
+            for (int i = 0; i != options.imagesPerDirectory; ++i) {
+                auto path = QDir(directory).filePath(QString("image %1.jpg").arg(i));
+
+                QFile file(path);
+                if (!file.open(QIODevice::WriteOnly) || file.write(placeholder) != placeholder.size())
+                    return std::unexpected(QString("Could not write %1: %2").arg(path, file.errorString()));
+                file.close();
+
+                auto fileTags = fileTagsManager.forFile(path);
+                if (!fileTags)
+                    return std::unexpected(fileTags.error());
+
+                QStringList tags;
+                auto count = random.bounded(options.minTagsPerImage, options.maxTagsPerImage + 1);
+                for (int t = 0; t != count; ++t)
+                    tags.append(pickTag());
+                std::ignore = (*fileTags)->setTags(tags, true);
+
+                if (random.generateDouble() < options.regionProbability)
+                    std::ignore = (*fileTags)->setImageRegion(randomRegion());
+                if (random.generateDouble() < options.completeProbability)
+                    std::ignore = (*fileTags)->setCompleteFlag(true);
+
+                // untouched images get no tags file, the same as in the application
+                if (auto result = (*fileTags)->save(); !result)
+                    return std::unexpected(result.error());
+
+                images.append(path);
+            }
+
+            fileTagsManager.flushSaves();
+            if (saveError)
+                return std::unexpected(*saveError);
+        }
+    }
+
+    if (auto result = project->save(false); !result)
+        return std::unexpected(result.error());
+
+    return images;
+}
+
+QString projectFilePath(QString const &rootDir) {
+    return QDir(rootDir).filePath("project.simtagproj");
+}
+}
@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+namespace TagLibrary {
+class Library;
+}
+
+// Deterministic synthetic tag libraries and projects, for load testing and benchmarks. The same options and seed always
+// produce the same content, apart from UUIDs.
+namespace Synthetic {
+struct LibraryOptions {
+    int collections = 10;
+    int objectsPerCollection = 20;
+    // levels of objects below a collection, and number of children of every object above the last level
+    int depth = 3;
+    int fanOut = 3;
+    int tagsPerObject = 2;
+    // probability of a node below the first level being a link or an inheritance node instead of an object; these
+    // point at objects of the preceding collections
+    double linkProbability = 0.0;
+    double inheritanceProbability = 0.0;
+};
+
+enum class TagDistribution {
+    Uniform,
+    // tags ordered by the library, k-th of them picked with probability proportional to 1/k
+    Zipf
+};
+
+struct ProjectOptions {
+    // the tree is made of top-level project directories, each with the given number of subdirectories, and images
+    // placed in all of them
+    int directories = 10;
+    int subdirectories = 0;
+    int imagesPerDirectory = 100;
+    QSize imageSize{64, 48};
+
+    int minTagsPerImage = 0;
+    int maxTagsPerImage = 10;
+    TagDistribution tagDistribution = TagDistribution::Zipf;
+    // probability of an assigned tag not being known to the library
+    double unknownTagProbability = 0.0;
+    double regionProbability = 0.0;
+    double completeProbability = 0.0;
+};
+
+[[nodiscard]] std::expected<QCborValue, QString> makeLibraryRoot(LibraryOptions const &options, QRandomGenerator &random);
+
+// Tag library file content with the given root node, as Library::saveContent() would write it.
+[[nodiscard]] QByteArray makeLibraryContent(QCborValue const &root);
+
+// Writes a library generated with makeLibraryRoot() to the given file and loads it back from there, the way the
+// application opens it.
+[[nodiscard]] std::expected<std::unique_ptr<TagLibrary::Library>, QString> makeLibrary(
+        QString const &path,
+        LibraryOptions const &options,
+        QRandomGenerator &random
+);
+
+// Creates a project file in the given directory, with images and their tags files saved against the given
+// library. Returns paths of the created images.
+[[nodiscard]] std::expected<QStringList, QString> makeProject(
+        QString const &rootDir,
+        ProjectOptions const &options,
+        TagLibrary::Library &library,
+        QRandomGenerator &random
+);
+
+[[nodiscard]] QString projectFilePath(QString const &rootDir);
+}
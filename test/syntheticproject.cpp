@@ -0,0 +1,87 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "synthetic.hpp"
+
+#include "../src/FileTagsManager.hpp"
+#include "../src/TagLibrary/Library.hpp"
+
+namespace {
+// Tags of every image of a project generated into the directory from the given seed, by path relative to it.
+std::expected<QHash<QString, QStringList>, QString> generateProject(QString const &rootDir, quint32 const seed) {
+    QRandomGenerator random(seed);
+
+    Synthetic::LibraryOptions libraryOptions{
+            .collections = 5,
+            .objectsPerCollection = 10,
+            .depth = 2,
+            .fanOut = 2
+    };
+    auto library = Synthetic::makeLibrary(QDir(rootDir).filePath("TagLibrary.cbor"), libraryOptions, random);
+    if (!library)
+        return std::unexpected(library.error());
+
+    Synthetic::ProjectOptions projectOptions{
+            .directories = 2,
+            .imagesPerDirectory = 25,
+            .imageSize = QSize(8, 8),
+            .minTagsPerImage = 1,
+            .maxTagsPerImage = 5
+    };
+    auto images = Synthetic::makeProject(rootDir, projectOptions, **library, random);
+    if (!images)
+        return std::unexpected(images.error());
+
+    FileTagsManager manager(false);
+    QHash<QString, QStringList> tags;
+    for (auto const &image: *images) {
+        auto fileTags = manager.forFile(image);
+        if (!fileTags)
+            return std::unexpected(fileTags.error());
+        tags.insert(QDir(rootDir).relativeFilePath(image), (*fileTags)->assignedTags());
+    }
+    return tags;
+}
+}
+
+class TestSyntheticProject: public QObject {
+    Q_OBJECT
+
+private slots:
+    // The same seed must give the same images the same tags. Each generation runs with a QHash seed of its own, the
+    // same as separate runs of the generator do, so that nothing may depend on hash order.
+    void testReproducible() {
+        QTemporaryDir first;
+        QVERIFY(first.isValid());
+        auto firstTags = generateProject(first.path(), 1);
+        QVERIFY2(firstTags, qPrintable(firstTags.error()));
+        QCOMPARE(firstTags->size(), 50);
+
+        QHashSeed::resetRandomGlobalSeed();
+
+        QTemporaryDir second;
+        QVERIFY(second.isValid());
+        auto secondTags = generateProject(second.path(), 1);
+        QVERIFY2(secondTags, qPrintable(secondTags.error()));
+
+        for (auto const &[image, tags]: firstTags->asKeyValueRange())
+            QCOMPARE(secondTags->value(image), tags);
+        QCOMPARE(secondTags->size(), firstTags->size());
+    }
+};
+
+QTEST_MAIN(TestSyntheticProject)
+#include "syntheticproject.moc"
@@ -0,0 +1,651 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "synthetic.hpp"
+
+#include "../src/TagLibrary/Library.hpp"
+#include "../src/TagLibrary/Model.hpp"
+
+namespace {
+constexpr quint32 SEED = 1;
+
+// three collections of three objects with a child each, as editLibrary() expects
+constexpr Synthetic::LibraryOptions EDITED_LIBRARY{.collections = 3, .objectsPerCollection = 3, .depth = 2, .fanOut = 1};
+
+void resetPeakRss() {
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/clear_refs");
+    if (file.open(QIODevice::WriteOnly))
+        file.write("5");
+#endif
+}
+
+// Peak resident set size since the last resetPeakRss(), in KiB, or -1 where unsupported.
+qint64 peakRss() {
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/status");
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        for (auto const &line: file.readAll().split('\n'))
+            if (line.startsWith("VmHWM:"))
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+#endif
+    return -1;
+}
+
+// Rows of the subtree as the model presents them, one line per row with its name, tags and UUID, indented by depth.
+QStringList dumpTree(TagLibrary::Model const &model, QModelIndex const &parent = QModelIndex(), int const depth = 0) {
+    QStringList lines;
+    for (int row = 0; row != model.rowCount(parent); ++row) {
+        auto index = model.index(row, 0, parent);
+        auto node = model.fromIndex(index);
+        lines.append(QString("%1%2 [%3] %4").arg(
+                QString(depth * 2, QChar(' ')),
+                index.data(Qt::DisplayRole).toString(),
+                index.siblingAtColumn(1).data(Qt::DisplayRole).toString(),
+                node ? node->uuid().toString(QUuid::WithoutBraces) : QString()
+        ));
+        lines.append(dumpTree(model, index, depth + 1));
+    }
+    return lines;
+}
+
+// Nodes of the rows directly under the parent and one level below, by their names.
+QHash<QString, std::shared_ptr<TagLibrary::Node>> nodesByName(TagLibrary::Model const &model, QModelIndex const &parent) {
+    QHash<QString, std::shared_ptr<TagLibrary::Node>> nodes;
+    for (int row = 0; row != model.rowCount(parent); ++row) {
+        auto index = model.index(row, 0, parent);
+        nodes.insert(index.data(Qt::DisplayRole).toString(), model.fromIndex(index));
+        for (int childRow = 0; childRow != model.rowCount(index); ++childRow) {
+            auto child = model.index(childRow, 0, index);
+            nodes.insert(child.data(Qt::DisplayRole).toString(), model.fromIndex(child));
+        }
+    }
+    return nodes;
+}
+
+// A fresh model holding what the given one saves.
+std::expected<std::unique_ptr<TagLibrary::Model>, QString> rebuild(TagLibrary::Model const &model) {
+    auto value = model.save();
+    if (!value)
+        return std::unexpected(value.error());
+
+    auto rebuilt = std::make_unique<TagLibrary::Model>();
+    if (auto result = rebuilt->load(*value); !result)
+        return std::unexpected(result.error());
+    return rebuilt;
+}
+
+// Rows below the parent, counted by walking the model.
+int countRows(TagLibrary::Model const &model, QModelIndex const &parent) {
+    int count = model.rowCount(parent);
+    for (int row = 0, rows = count; row != rows; ++row)
+        count += countRows(model, model.index(row, 0, parent));
+    return count;
+}
+
+// Nodes of the subtree whose answers based on the cached subtree aggregates differ from what visiting all of their
+// descendants gives, for each of the versions.
+QStringList aggregateMismatches(
+        TagLibrary::Model const &model, QList<int> const &versions, QModelIndex const &parent = QModelIndex()
+) {
+    QStringList mismatches;
+    for (int row = 0; row != model.rowCount(parent); ++row) {
+        auto index = model.index(row, 0, parent);
+        auto node = model.fromIndex(index);
+        auto path = node->path();
+
+        std::optional<int> maxLastChangeVersion;
+        bool anyActive = false;
+        bool anyHighlighted = false;
+        if (auto result = node->visit(TagLibrary::Node::VisitFlag::Recursive,
+                [&](auto const &visited) -> std::expected<bool, Error> {
+            if (auto version = visited->lastChangeVersion())
+                maxLastChangeVersion = std::max(maxLastChangeVersion.value_or(*version), *version);
+            if (auto active = visited->active(); active && *active)
+                anyActive = true;
+            if (auto highlighted = visited->highlighted(); highlighted && *highlighted)
+                anyHighlighted = true;
+            return true;
+        }); !result) {
+            mismatches.append(QString("%1: %2").arg(path, result.error()));
+            continue;
+        }
+
+        for (auto const version: versions) {
+            auto changed = node->lastChangeAfter(version, true, false);
+            if (!changed || *changed != (maxLastChangeVersion && *maxLastChangeVersion > version))
+                mismatches.append(QString("%1: lastChangeAfter(%2)").arg(path).arg(version));
+        }
+
+        QList<Qt::BrushStyle> expectedStyles;
+        if (auto active = node->active(); active && *active)
+            expectedStyles.append(Qt::SolidPattern);
+        if (anyActive)
+            expectedStyles.append(Qt::FDiagPattern);
+        if (auto highlighted = node->highlighted(); highlighted && *highlighted)
+            expectedStyles.append(Qt::SolidPattern);
+        if (anyHighlighted)
+            expectedStyles.append(Qt::BDiagPattern);
+
+        auto styles = node->background(false)
+                | std::views::transform([](QBrush const &brush){ return brush.style(); })
+                | std::ranges::to<QList<Qt::BrushStyle>>();
+        if (styles != expectedStyles)
+            mismatches.append(QString("%1: background").arg(path));
+
+        if (model.recursiveRowCount(index) != countRows(model, index))
+            mismatches.append(QString("%1: recursiveRowCount").arg(path));
+
+        mismatches.append(aggregateMismatches(model, versions, index));
+    }
+    return mismatches;
+}
+
+QByteArray savedContent(TagLibrary::Model const &model) {
+    auto value = model.save();
+    return value ? value->toCbor() : QByteArray{};
+}
+
+// Moves the row under another parent the way a view does it: drops a copy of the node, then removes the original.
+bool moveRow(TagLibrary::Model &model, QModelIndex const &index, QModelIndex const &parent) {
+    std::unique_ptr<QMimeData> data(model.mimeData({index}));
+    return data
+            && model.dropMimeData(&*data, Qt::MoveAction, -1, 0, parent)
+            && model.removeRows(index.row(), 1, index.parent());
+}
+
+// One of the successive changes of a library generated with EDITED_LIBRARY.
+bool editLibrary(TagLibrary::Model &model, int const step) {
+    auto rootCollection = model.index(0, 0, QModelIndex());
+    auto collection = [&](int const row){ return model.index(row, 0, rootCollection); };
+
+    switch (step) {
+        case 0: {
+            auto object = model.index(0, 0, collection(0));
+            return model.setData(object, QString("renamed")) && model.setData(object.siblingAtColumn(1), QString("renamed_tag"));
+        }
+        case 1: {
+            // the child keeps its default content, so it gets saved only because it's new
+            auto object = model.insertNode(TagLibrary::NodeType::Object, collection(1));
+            return object
+                    && model.setData(object->siblingAtColumn(0), QString("inserted"))
+                    && model.insertNode(TagLibrary::NodeType::Object, *object);
+        }
+        case 2:
+            return moveRow(model, model.index(1, 0, collection(0)), collection(2));
+        case 3:
+            return model.removeRows(0, 1, collection(1));
+        case 4:
+            // along with the object moved into it
+            return model.removeRows(2, 1, rootCollection);
+        default:
+            return false;
+    }
+}
+
+std::expected<void, QString> saveJournal(TagLibrary::Library &library, QString const &path) {
+    QFile file(path);
+    return library.saveJournal(file);
+}
+
+// Library loaded from the file and, if there's one, its journal, as MainWindow does it.
+std::expected<std::unique_ptr<TagLibrary::Library>, QString> loadLibrary(QString const &path, QString const &journalPath) {
+    auto library = TagLibrary::Library::create(path);
+    if (!library)
+        return library;
+
+    QFile file(path);
+    QFile journal(journalPath);
+    if (auto result = (*library)->loadContent(file, journal.exists() ? &journal : nullptr); !result)
+        return std::unexpected(result.error());
+    return library;
+}
+}
+
+class TestTagLibrary: public QObject {
+    Q_OBJECT
+
+private slots:
+    // Moves a linked object by drag and drop with its children changed on the way, which makes the link synchronize
+    // its shadows with the recreated target. Children named in "children" that exist are kept (same UUID and subtree),
+    // any other name gets a new child.
+    void testShadowSynchronize() {
+        QFETCH(QStringList, children);
+        QFETCH(QStringList, kept);
+
+        using TagLibrary::Format::NodeKey;
+
+        TagLibrary::Model model;
+        QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+        QVERIFY(model.resetRoot());
+
+        auto rootCollection = model.index(0, 0, QModelIndex());
+        auto collection = model.insertNode(TagLibrary::NodeType::Collection, rootCollection);
+        QVERIFY(collection);
+        auto target = model.insertNode(TagLibrary::NodeType::Object, *collection);
+        QVERIFY(target);
+        QVERIFY(model.setData(target->siblingAtColumn(0), QString("target")));
+
+        for (int i = 0; i != 5; ++i) {
+            auto child = model.insertNode(TagLibrary::NodeType::Object, *target);
+            QVERIFY(child);
+            QVERIFY(model.setData(child->siblingAtColumn(0), QString("o%1").arg(i)));
+            QVERIFY(model.setData(child->siblingAtColumn(1), QString("tag_%1").arg(i)));
+
+            auto grandchild = model.insertNode(TagLibrary::NodeType::Object, *child);
+            QVERIFY(grandchild);
+            QVERIFY(model.setData(grandchild->siblingAtColumn(0), QString("o%1.0").arg(i)));
+        }
+
+        auto linkCollection = model.insertNode(TagLibrary::NodeType::Collection, rootCollection);
+        QVERIFY(linkCollection);
+        auto link = model.insertNode(TagLibrary::NodeType::Link, *linkCollection);
+        QVERIFY(link);
+        QVERIFY(model.fromIndex(*link)->setLinkTo(model.fromIndex(*target)->uuid()));
+        QCOMPARE(model.rowCount(*link), 5);
+
+        auto shadowsBefore = nodesByName(model, *link);
+
+        // the target as dragged, with its children replaced by the requested ones
+        std::unique_ptr<QMimeData> dragged(model.mimeData({*target}));
+        QVERIFY(dragged);
+        auto entries = QCborValue::fromCbor(dragged->data(TagLibrary::mimeType.toString())).toArray();
+        QCOMPARE(gsl::narrow<int>(entries.size()), 1);
+        auto entry = entries.at(0).toMap();
+        auto node = entry.value(std::to_underlying(TagLibrary::NodesMimeKey::NodeData)).toMap();
+
+        QHash<QString, QCborMap> childrenByName;
+        for (auto const &child: node.value(std::to_underlying(NodeKey::Children)).toArray())
+            childrenByName.insert(child.toMap().value(std::to_underlying(NodeKey::Name)).toString(), child.toMap());
+
+        QCborArray newChildren;
+        for (auto const &name: children) {
+            if (auto it = childrenByName.find(name); it != childrenByName.end()) {
+                newChildren.append(*it);
+            } else {
+                auto child = childrenByName.value("o0");
+                child[std::to_underlying(NodeKey::Uuid)] = QUuid::createUuid().toRfc4122();
+                child[std::to_underlying(NodeKey::Name)] = name;
+                child[std::to_underlying(NodeKey::Children)] = QCborArray();
+                newChildren.append(child);
+            }
+        }
+        node[std::to_underlying(NodeKey::Children)] = newChildren;
+        entry[std::to_underlying(TagLibrary::NodesMimeKey::NodeData)] = node;
+
+        QMimeData dropped;
+        dropped.setData(TagLibrary::mimeType.toString(), QCborArray{entry}.toCborValue().toCbor());
+
+        // what a view does for a move: drop the copy, then remove the original
+        QVERIFY(model.dropMimeData(&dropped, Qt::MoveAction, -1, 0, *collection));
+        QVERIFY(model.removeRows(target->row(), 1, *collection));
+        QCOMPARE(model.rowCount(*collection), 1);
+        QCOMPARE(model.rowCount(*link), gsl::narrow<int>(children.size()));
+
+        auto rebuilt = rebuild(model);
+        QVERIFY2(rebuilt, qPrintable(rebuilt.error()));
+        QCOMPARE(dumpTree(model), dumpTree(**rebuilt));
+
+        // shadows in the longest run of unchanged order are updated in place, along with their subtrees
+        auto shadowsAfter = nodesByName(model, *link);
+        for (auto const &name: kept) {
+            QVERIFY(shadowsAfter.value(name) == shadowsBefore.value(name));
+            QVERIFY(shadowsAfter.value(name + ".0") == shadowsBefore.value(name + ".0"));
+        }
+        for (auto const &name: children)
+            if (!kept.contains(name))
+                QVERIFY(shadowsAfter.value(name) != shadowsBefore.value(name));
+    }
+
+    void testShadowSynchronize_data() {
+        QTest::addColumn<QStringList>("children");
+        QTest::addColumn<QStringList>("kept");
+
+        QTest::newRow("unchanged") << QStringList{"o0", "o1", "o2", "o3", "o4"} << QStringList{"o0", "o1", "o2", "o3", "o4"};
+        QTest::newRow("reorder") << QStringList{"o1", "o2", "o3", "o4", "o0"} << QStringList{"o1", "o2", "o3", "o4"};
+        QTest::newRow("insert") << QStringList{"n0", "o0", "o1", "n1", "n2", "o2", "o3", "o4", "n3"} << QStringList{"o0", "o1", "o2", "o3", "o4"};
+        QTest::newRow("remove") << QStringList{"o0", "o2", "o4"} << QStringList{"o0", "o2", "o4"};
+        QTest::newRow("replace") << QStringList{"o0", "o1", "r2", "o3", "o4"} << QStringList{"o0", "o1", "o3", "o4"};
+        QTest::newRow("mixed") << QStringList{"n0", "o3", "o4", "o0", "r1"} << QStringList{"o3", "o4"};
+        QTest::newRow("clear") << QStringList{} << QStringList{};
+    }
+
+    // Loads the same library through a full CBOR tree and straight from the stream; both must end up with the same
+    // nodes, links, inheritance and shadows.
+    void testStreamingLoad() {
+        QRandomGenerator random(SEED);
+        auto root = Synthetic::makeLibraryRoot({
+                .collections = 4, .objectsPerCollection = 5, .depth = 2, .fanOut = 2,
+                .linkProbability = 0.25, .inheritanceProbability = 0.25
+        }, random);
+        QVERIFY2(root, qPrintable(root.error()));
+        auto content = root->toCbor();
+
+        TagLibrary::Model dom;
+        QVERIFY(dom.resetRoot());
+        QVERIFY(dom.load(QCborValue::fromCbor(content)));
+
+        TagLibrary::Model streamed;
+        QVERIFY(streamed.resetRoot());
+        QCborStreamReader reader(content);
+        QVERIFY(streamed.load(reader));
+
+        auto domSaved = dom.save();
+        QVERIFY2(domSaved, qPrintable(domSaved.error()));
+        auto streamedSaved = streamed.save();
+        QVERIFY2(streamedSaved, qPrintable(streamedSaved.error()));
+        QCOMPARE(streamedSaved->toCbor(), domSaved->toCbor());
+        QCOMPARE(domSaved->toCbor(), content);
+
+        for (auto editMode: {false, true}) {
+            dom.setEditMode(editMode);
+            streamed.setEditMode(editMode);
+            auto tree = dumpTree(dom);
+            QCOMPARE(dumpTree(streamed), tree);
+            QCOMPARE(streamed.recursiveRowCount(QModelIndex()), dom.recursiveRowCount(QModelIndex()));
+        }
+    }
+
+    // Changes the state covered by the subtree aggregates deep in a subtree, which is also linked to, and checks every
+    // node against a visit of its whole subtree after each change.
+    void testSubtreeAggregates() {
+        TagLibrary::Model model;
+        QVERIFY(model.resetRoot());
+        model.setNextLibraryVersion(1);
+
+        auto rootCollection = model.index(0, 0, QModelIndex());
+        auto collection = model.insertNode(TagLibrary::NodeType::Collection, rootCollection);
+        QVERIFY(collection);
+
+        // two objects on each of four levels below every object
+        auto insertObjects = [&](this auto const &self, QModelIndex const &parent, QString const &path, int const levels) -> bool {
+            for (int i = 0; i != 2; ++i) {
+                auto childPath = QString("%1_%2").arg(path).arg(i);
+                auto object = model.insertNode(TagLibrary::NodeType::Object, parent);
+                if (!object
+                        || !model.setData(object->siblingAtColumn(0), QString("object%1").arg(childPath))
+                        || !model.setData(object->siblingAtColumn(1), QString("tag%1").arg(childPath)))
+                    return false;
+                if (levels > 1 && !self(*object, childPath, levels - 1))
+                    return false;
+            }
+            return true;
+        };
+        QVERIFY(insertObjects(*collection, QString(), 4));
+
+        auto linkCollection = model.insertNode(TagLibrary::NodeType::Collection, rootCollection);
+        QVERIFY(linkCollection);
+        auto link = model.insertNode(TagLibrary::NodeType::Link, *linkCollection);
+        QVERIFY(link);
+        QVERIFY(model.fromIndex(*link)->setLinkTo(model.fromIndex(model.index(0, 0, *collection))->uuid()));
+
+        auto objectAt = [&](std::initializer_list<int> const rows) {
+            auto index = *collection;
+            for (auto const row: rows)
+                index = model.index(row, 0, index);
+            return index;
+        };
+        auto resolvedTag = [&](QModelIndex const &index) {
+            auto tags = model.fromIndex(index)->tags();
+            return tags.empty() ? QString() : tags.front().resolved;
+        };
+
+        auto deep = objectAt({0, 1, 0, 1});
+        auto deepTag = resolvedTag(deep);
+        QVERIFY(!deepTag.isEmpty());
+        auto otherDeepTag = resolvedTag(objectAt({0, 0, 1, 1}));
+        QVERIFY(!otherDeepTag.isEmpty());
+
+        QList<int> const versions{0, 1, 4, 5};
+        auto verify = [&] {
+            auto mismatches = aggregateMismatches(model, versions);
+            for (auto const &mismatch: mismatches)
+                qWarning() << "mismatch:" << mismatch;
+            return mismatches.isEmpty();
+        };
+
+        // fills the caches, so that the changes below have to invalidate them
+        QVERIFY(verify());
+
+        QVERIFY(model.setTagsActive({deepTag}));
+        QVERIFY(verify());
+
+        QVERIFY(model.setHighlightedTags({otherDeepTag}));
+        QVERIFY(verify());
+
+        model.setNextLibraryVersion(5);
+        QVERIFY(model.setData(deep, QString("renamed")));
+        QVERIFY(verify());
+
+        QVERIFY(model.insertNode(TagLibrary::NodeType::Object, deep));
+        QVERIFY(verify());
+
+        QVERIFY(model.removeRows(1, 1, objectAt({0, 0})));
+        QVERIFY(verify());
+
+        QVERIFY(model.setTagsActive({}));
+        QVERIFY(model.setHighlightedTags({}));
+        QVERIFY(verify());
+
+        model.setEditMode(true);
+        QVERIFY(verify());
+    }
+
+    // Saves the given number of successive changes to the journal, one entry each; the library loaded with the journal
+    // must be the same as the one that saved it.
+    void testJournalReplay() {
+        QFETCH(int, entries);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto path = dir.filePath("library.cbor");
+        auto journalPath = path + ".journal";
+
+        QRandomGenerator random(SEED);
+        auto library = Synthetic::makeLibrary(path, EDITED_LIBRARY, random);
+        QVERIFY2(library, qPrintable(library.error()));
+
+        for (int step = 0; step != entries; ++step) {
+            QVERIFY(editLibrary((*library)->model(), step));
+            QVERIFY(saveJournal(**library, journalPath));
+        }
+
+        auto loaded = loadLibrary(path, journalPath);
+        QVERIFY2(loaded, qPrintable(loaded.error()));
+        QCOMPARE(savedContent((*loaded)->model()), savedContent((*library)->model()));
+        QCOMPARE(dumpTree((*loaded)->model()), dumpTree((*library)->model()));
+        QCOMPARE((*loaded)->getVersion(), (*library)->getVersion());
+        QCOMPARE((*loaded)->getVersionUuid(), (*library)->getVersionUuid());
+    }
+
+    void testJournalReplay_data() {
+        QTest::addColumn<int>("entries");
+
+        QTest::newRow("rename") << 1;
+        QTest::newRow("insert") << 2;
+        QTest::newRow("move") << 3;
+        QTest::newRow("remove") << 4;
+        QTest::newRow("remove moved") << 5;
+    }
+
+    // An entry cut short by an interrupted save is dropped, along with nothing before it.
+    void testJournalTruncated() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto path = dir.filePath("library.cbor");
+        auto journalPath = path + ".journal";
+
+        QRandomGenerator random(SEED);
+        auto library = Synthetic::makeLibrary(path, EDITED_LIBRARY, random);
+        QVERIFY2(library, qPrintable(library.error()));
+
+        QVERIFY(editLibrary((*library)->model(), 0));
+        QVERIFY(saveJournal(**library, journalPath));
+        auto content = savedContent((*library)->model());
+        auto version = (*library)->getVersion();
+        auto versionUuid = (*library)->getVersionUuid();
+
+        QVERIFY(editLibrary((*library)->model(), 1));
+        QVERIFY(saveJournal(**library, journalPath));
+        QVERIFY(QFile::resize(journalPath, QFileInfo(journalPath).size() - 3));
+
+        auto loaded = loadLibrary(path, journalPath);
+        QVERIFY2(loaded, qPrintable(loaded.error()));
+        QCOMPARE(savedContent((*loaded)->model()), content);
+        QCOMPARE((*loaded)->getVersion(), version);
+        QCOMPARE((*loaded)->getVersionUuid(), versionUuid);
+    }
+
+    // Saving without changes appends nothing and keeps the version.
+    void testJournalEmpty() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto path = dir.filePath("library.cbor");
+        auto journalPath = path + ".journal";
+
+        QRandomGenerator random(SEED);
+        auto library = Synthetic::makeLibrary(path, EDITED_LIBRARY, random);
+        QVERIFY2(library, qPrintable(library.error()));
+
+        auto version = (*library)->getVersion();
+        auto versionUuid = (*library)->getVersionUuid();
+        QVERIFY(saveJournal(**library, journalPath));
+        QVERIFY(!QFile::exists(journalPath));
+        QCOMPARE((*library)->getVersion(), version);
+        QCOMPARE((*library)->getVersionUuid(), versionUuid);
+
+        QVERIFY(editLibrary((*library)->model(), 0));
+        QVERIFY(saveJournal(**library, journalPath));
+        auto size = QFileInfo(journalPath).size();
+        QVERIFY(saveJournal(**library, journalPath));
+        QCOMPARE(QFileInfo(journalPath).size(), size);
+    }
+
+    // Once the library has been rewritten, a journal left behind (e.g. because it couldn't be removed) no longer
+    // continues its version and must not be replayed on top of it.
+    void testJournalStale() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        auto path = dir.filePath("library.cbor");
+        auto journalPath = path + ".journal";
+
+        QRandomGenerator random(SEED);
+        auto library = Synthetic::makeLibrary(path, EDITED_LIBRARY, random);
+        QVERIFY2(library, qPrintable(library.error()));
+
+        QVERIFY(editLibrary((*library)->model(), 0));
+        QVERIFY(saveJournal(**library, journalPath));
+
+        // renames the same object again, so that replaying the stale entry would be visible
+        auto object = (*library)->model().index(0, 0, (*library)->model().index(0, 0, (*library)->model().index(0, 0, QModelIndex())));
+        QVERIFY((*library)->model().setData(object, QString("renamed again")));
+        {
+            QFile file(path);
+            QVERIFY((*library)->saveContent(file));
+        }
+
+        auto loaded = loadLibrary(path, journalPath);
+        QVERIFY2(loaded, qPrintable(loaded.error()));
+        QCOMPARE(savedContent((*loaded)->model()), savedContent((*library)->model()));
+        QCOMPARE((*loaded)->getVersion(), (*library)->getVersion());
+        QCOMPARE((*loaded)->getVersionUuid(), (*library)->getVersionUuid());
+    }
+
+    // Compares loading the library through a full CBOR tree with building the nodes straight from the stream.
+    void benchmarkLoad() {
+        QFETCH(bool, streaming);
+        QFETCH(int, collections);
+        QFETCH(int, objectsPerCollection);
+
+        QRandomGenerator random(SEED);
+        auto root = Synthetic::makeLibraryRoot({
+                .collections = collections, .objectsPerCollection = objectsPerCollection, .depth = 1
+        }, random);
+        QVERIFY2(root, qPrintable(root.error()));
+        auto content = root->toCbor();
+
+        TagLibrary::Model model;
+        QVERIFY(model.resetRoot());
+
+        auto load = [&] -> std::expected<void, QString> {
+            if (streaming) {
+                QCborStreamReader reader(content);
+                return model.load(reader);
+            } else {
+                return model.load(QCborValue::fromCbor(content));
+            }
+        };
+
+        // measured once outside of the benchmark loop, so that only a single load contributes to the peak
+        resetPeakRss();
+        auto before = peakRss();
+        QVERIFY(load());
+        qInfo() << "peak RSS (KiB) before:" << before << "after:" << peakRss();
+        QCOMPARE(model.rowCount(model.index(0, 0, QModelIndex())), collections);
+
+        QBENCHMARK {
+            QVERIFY(load());
+        }
+    }
+
+    void benchmarkLoad_data() {
+        QTest::addColumn<bool>("streaming");
+        QTest::addColumn<int>("collections");
+        QTest::addColumn<int>("objectsPerCollection");
+
+        for (auto streaming: {false, true}) {
+            auto name = streaming ? "stream" : "dom";
+            QTest::addRow("%s 100x100", name) << streaming << 100 << 100;
+            QTest::addRow("%s 100x1000", name) << streaming << 100 << 1000;
+        }
+    }
+
+    // Measures Model::toIndex() on the last child of a collection of the given width; the time per call should not
+    // depend on the number of siblings.
+    void benchmarkToIndex() {
+        QFETCH(int, siblings);
+
+        TagLibrary::Model model;
+        QVERIFY(model.resetRoot());
+
+        auto collection = model.index(0, 0, QModelIndex());
+        QVERIFY(collection.isValid());
+
+        for (int i = 0; i != siblings; ++i)
+            QVERIFY(model.insertNode(TagLibrary::NodeType::Object, collection));
+
+        auto last = model.fromIndex(model.index(siblings - 1, 0, collection));
+        QVERIFY(last);
+        QCOMPARE(model.toIndex(*last).row(), siblings - 1);
+
+        QBENCHMARK {
+            auto index = model.toIndex(*last);
+            QVERIFY(index.isValid());
+        }
+    }
+
+    void benchmarkToIndex_data() {
+        QTest::addColumn<int>("siblings");
+
+        QTest::newRow("10 siblings") << 10;
+        QTest::newRow("1000 siblings") << 1000;
+        QTest::newRow("10000 siblings") << 10000;
+    }
+};
+
+QTEST_MAIN(TestTagLibrary)
+#include "taglibrary.moc"
@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2024 fdresufdresu@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "../src/FileBrowser/Thumbnail.hpp"
+
+namespace {
+    constexpr int THUMBNAIL_HEIGHT = 80;
+
+    // ~24 MP, like typical camera images
+    constexpr QSize SYNTHETIC_IMAGE_SIZE{6000, 4000};
+    constexpr int SYNTHETIC_IMAGE_COUNT = 4;
+}
+
+// Compares reduced-size decoding against full decode. Uses JPEGs from the directory given in
+// SIMPLETAGGER_BENCH_IMAGE_DIR, or generates a few synthetic large ones when it's not set.
+class BenchmarkThumbnail: public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        if (auto dir = qEnvironmentVariable("SIMPLETAGGER_BENCH_IMAGE_DIR"); !dir.isEmpty()) {
+            QDirIterator iterator(dir, {"*.jpg", "*.jpeg"}, QDir::Filter::Files);
+            while (iterator.hasNext())
+                images_.append(iterator.next());
+        } else {
+            QVERIFY(tempDir_.isValid());
+
+            QImage image(SYNTHETIC_IMAGE_SIZE, QImage::Format::Format_RGB32);
+            for (int i = 0; i < SYNTHETIC_IMAGE_COUNT; ++i) {
+                for (int y = 0; y < image.height(); ++y) {
+                    auto line = reinterpret_cast<QRgb *>(image.scanLine(y));
+                    for (int x = 0; x < image.width(); ++x)
+                        line[x] = qRgb((x * (i + 1)) % 256, (y * (i + 2)) % 256, ((x ^ y) + i) % 256);
+                }
+
+                auto path = tempDir_.filePath(QString("image%1.jpg").arg(i));
+                QVERIFY(image.save(path, "JPG", 90));
+                images_.append(path);
+            }
+        }
+
+        QVERIFY(!images_.isEmpty());
+        qInfo() << "Benchmarking on" << images_.size() << "image(s)";
+    }
+
+    void testThumbnailSize() {
+        for (auto const &path: images_) {
+            auto reduced = FileBrowser::loadThumbnail(path, THUMBNAIL_HEIGHT);
+            auto full = FileBrowser::loadThumbnailFullDecode(path, THUMBNAIL_HEIGHT);
+            QCOMPARE(reduced.height(), THUMBNAIL_HEIGHT);
+            QVERIFY(std::abs(reduced.width() - full.width()) <= 1);
+        }
+    }
+
+    void benchmarkThumbnail() {
+        QFETCH(bool, reducedDecode);
+
+        QBENCHMARK {
+            for (auto const &path: images_) {
+                auto image = reducedDecode
+                        ? FileBrowser::loadThumbnail(path, THUMBNAIL_HEIGHT)
+                        : FileBrowser::loadThumbnailFullDecode(path, THUMBNAIL_HEIGHT);
+                QVERIFY(!image.isNull());
+            }
+        }
+    }
+
+    void benchmarkThumbnail_data() {
+        QTest::addColumn<bool>("reducedDecode");
+
+        QTest::newRow("full decode") << false;
+        QTest::newRow("reduced size decode") << true;
+    }
+
+private:
+    QTemporaryDir tempDir_;
+    QStringList images_;
+};
+
+QTEST_GUILESS_MAIN(BenchmarkThumbnail)
+#include "thumbnail.moc"